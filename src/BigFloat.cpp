@@ -0,0 +1,456 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+#include "BigFloat.hpp"
+#include "kernels/kernels.hpp"
+
+namespace LongArithm {
+
+namespace {
+// Number of significant bits of `a`, the top limb must be nonzero
+uint64_t bitLength(const uint32_t *a, size_t n) {
+	if (n == 0) return 0;
+	return 32 * static_cast<uint64_t>(n) - std::countl_zero(a[n - 1]);
+}
+
+// Writes `a` shifted left by `shift` bits into the zeroed `r`
+// `r` needs room for the significant bits of the result only
+void place(uint32_t *r, const uint32_t *a, size_t n, uint64_t shift) {
+	uint32_t *to = r + shift / 32;
+	uint32_t carry = kernels::shiftLeft(to, a, n, shift % 32);
+	if (carry != 0) to[n] = carry;
+}
+
+bool roundsAway(
+	RoundingMode mode, bool negative, bool roundBit, bool sticky, bool odd
+) {
+	switch (mode) {
+	case RoundingMode::NearestEven:
+		return roundBit && (sticky || odd);
+	case RoundingMode::NearestAway:
+		return roundBit;
+	case RoundingMode::TowardZero:
+		return false;
+	case RoundingMode::TowardPositive:
+		return !negative && (roundBit || sticky);
+	case RoundingMode::TowardNegative:
+		return negative && (roundBit || sticky);
+	}
+	return false;
+}
+} // namespace
+
+// *ROUNDING*
+
+bool BigFloat::isZero(void) const { return mantissa.empty(); }
+
+int64_t BigFloat::topBit(void) const {
+	return exponent + bitLength(mantissa.data(), mantissa.size());
+}
+
+void BigFloat::canonicalize(void) {
+	mantissa.resize(kernels::normalizedSize(mantissa.data(), mantissa.size()));
+	if (mantissa.empty()) {
+		exponent = 0;
+		sign = 1;
+		return;
+	}
+	// Erasing from the front only moves the window of `mantissa`
+	size_t zeros = kernels::lowZeroCount(mantissa.data(), mantissa.size());
+	mantissa.erase(mantissa.begin(), mantissa.begin() + zeros);
+	unsigned bits = std::countr_zero(mantissa[0]);
+	if (bits != 0) {
+		kernels::shiftRight(
+			mantissa.data(), mantissa.data(), mantissa.size(), bits
+		);
+		if (mantissa.back() == 0) mantissa.pop_back();
+	}
+	exponent += 32 * static_cast<int64_t>(zeros) + bits;
+}
+
+BigFloat BigFloat::rounded(
+	const uint32_t *m, size_t n, int64_t exponent, bool negative, bool sticky,
+	uint64_t drop, uint32_t precision, RoundingMode mode
+) {
+	BigFloat result;
+	result.precision = precision;
+	result.sign = negative ? -1 : 1;
+	result.exponent = exponent + static_cast<int64_t>(drop);
+	n = kernels::normalizedSize(m, n);
+
+	// The highest bit cut off decides the direction, the ones below it
+	// only whether the value lies exactly halfway
+	bool roundBit = false;
+	if (drop > 0) {
+		uint64_t index = drop - 1;
+		if (index / 32 < n) {
+			uint32_t limb = m[index / 32];
+			uint32_t below = limb & ((uint32_t(1) << index % 32) - 1);
+			roundBit = limb >> index % 32 & 1;
+			sticky |= below != 0 || kernels::normalizedSize(m, index / 32) != 0;
+		} else {
+			sticky |= n != 0;
+		}
+	}
+	if (drop / 32 < n) {
+		size_t keep = n - drop / 32;
+		result.mantissa.resize(keep);
+		kernels::shiftRight(
+			result.mantissa.data(), m + drop / 32, keep, drop % 32
+		);
+	}
+
+	bool odd = !result.mantissa.empty() && (result.mantissa[0] & 1);
+	if (roundsAway(mode, negative, roundBit, sticky, odd)) {
+		if (result.mantissa.empty()) {
+			result.mantissa.push_back(1);
+		} else {
+			uint32_t one = 1;
+			uint32_t carry = kernels::addInPlace(
+				result.mantissa.data(), result.mantissa.size(), &one, 1
+			);
+			// 2^precision, becomes a single bit below
+			if (carry != 0) result.mantissa.push_back(carry);
+		}
+	}
+	result.canonicalize();
+	return result;
+}
+
+BigFloat BigFloat::roundToPrecision(
+	const uint32_t *m, size_t n, int64_t exponent, bool negative, bool sticky,
+	uint32_t precision, RoundingMode mode
+) {
+	if (precision == 0)
+		throw std::invalid_argument("Precision must be positive");
+	n = kernels::normalizedSize(m, n);
+	uint64_t bits = bitLength(m, n);
+	uint64_t drop = bits > precision ? bits - precision : 0;
+	return rounded(m, n, exponent, negative, sticky, drop, precision, mode);
+}
+
+// *CONSTRUCTORS*
+
+BigFloat::BigFloat(long double value, uint32_t precision, RoundingMode mode) {
+	if (!std::isfinite(value))
+		throw std::invalid_argument("BigFloat must be finite");
+	// |value| = fraction * 2^power, 0.5 <= fraction < 1
+	int power = 0;
+	long double fraction = std::frexp(std::abs(value), &power);
+	// The 64 bit mantissa of a long double fits without rounding
+	uint64_t bits = static_cast<uint64_t>(std::ldexp(fraction, 64));
+	uint32_t limbs[2] = {
+		static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32)
+	};
+	*this = roundToPrecision(
+		limbs, 2, power - 64, std::signbit(value), false, precision, mode
+	);
+}
+
+BigFloat::BigFloat(
+	const LongNumber &value, uint32_t precision, RoundingMode mode
+) {
+	std::span<const uint32_t> chunks = value.getChunks();
+	uint32_t fractionBits = value.getPrecision();
+	int64_t fractionChunks = (static_cast<int64_t>(fractionBits) + 31) / 32;
+	kernels::Limbs limbs(chunks.begin(), chunks.end());
+	// The fraction starts at the top of the lowest chunk
+	if (fractionBits % 32 != 0 && !limbs.empty())
+		limbs[0] &= ~(UINT32_MAX >> fractionBits % 32);
+	*this = roundToPrecision(
+		limbs.data(), limbs.size(), -32 * fractionChunks, value.getSign() < 0,
+		false, precision, mode
+	);
+}
+
+// *PRECISION*
+
+uint32_t BigFloat::getPrecision(void) const { return precision; }
+
+void BigFloat::setPrecision(uint32_t precision, RoundingMode mode) {
+	*this = withPrecision(precision, mode);
+}
+
+BigFloat BigFloat::withPrecision(uint32_t precision, RoundingMode mode) const {
+	return roundToPrecision(
+		mantissa.data(), mantissa.size(), exponent, sign < 0, false, precision,
+		mode
+	);
+}
+
+short BigFloat::getSign(void) const { return sign; }
+
+int64_t BigFloat::getExponent(void) const { return exponent; }
+
+std::span<const uint32_t> BigFloat::getMantissa(void) const {
+	return std::span<const uint32_t>(mantissa.data(), mantissa.size());
+}
+
+// *ARITHMETIC*
+
+BigFloat BigFloat::addSigned(
+	const BigFloat &a, const BigFloat &b, bool subtract, uint32_t precision,
+	RoundingMode mode
+) {
+	bool negativeA = a.sign < 0;
+	bool negativeB = (b.sign < 0) != subtract;
+	if (b.isZero())
+		return roundToPrecision(
+			a.mantissa.data(), a.mantissa.size(), a.exponent, negativeA, false,
+			precision, mode
+		);
+	if (a.isZero())
+		return roundToPrecision(
+			b.mantissa.data(), b.mantissa.size(), b.exponent, negativeB, false,
+			precision, mode
+		);
+
+	// `x` is the operand with the higher top bit
+	const BigFloat *x = &a, *y = &b;
+	bool negativeX = negativeA, negativeY = negativeB;
+	if (b.topBit() > a.topBit()) {
+		std::swap(x, y);
+		std::swap(negativeX, negativeY);
+	}
+
+	// Rounding boundaries of the sum are multiples of 2^low. A `y` below
+	// 2^low only tells in which direction to round, so it is replaced by
+	// a single bit and the limbs in between are never touched
+	int64_t low = std::min<int64_t>(
+		x->exponent, x->topBit() - static_cast<int64_t>(precision) - 2
+	);
+	const uint32_t stickyBit = 1;
+	const uint32_t *yLimbs = y->mantissa.data();
+	size_t ySize = y->mantissa.size();
+	int64_t yExponent = y->exponent;
+	if (y->topBit() <= low) {
+		yLimbs = &stickyBit;
+		ySize = 1;
+		yExponent = low - 1;
+	}
+
+	int64_t bottom = std::min(x->exponent, yExponent);
+	// One limb on top for the carry
+	size_t n = (x->topBit() - bottom) / 32 + 2;
+	kernels::Limbs sum(n, 0), other(n, 0);
+	place(
+		sum.data(), x->mantissa.data(), x->mantissa.size(), x->exponent - bottom
+	);
+	place(other.data(), yLimbs, ySize, yExponent - bottom);
+
+	bool negative = negativeX;
+	if (negativeX == negativeY) {
+		kernels::addN(sum.data(), sum.data(), other.data(), n);
+	} else {
+		int order = kernels::compareN(sum.data(), other.data(), n);
+		if (order == 0)
+			return roundToPrecision(
+				nullptr, 0, 0, false, false, precision, mode
+			);
+		if (order > 0) {
+			kernels::subN(sum.data(), sum.data(), other.data(), n);
+		} else {
+			kernels::subN(sum.data(), other.data(), sum.data(), n);
+			negative = negativeY;
+		}
+	}
+	return roundToPrecision(
+		sum.data(), n, bottom, negative, false, precision, mode
+	);
+}
+
+BigFloat BigFloat::add(
+	const BigFloat &a, const BigFloat &b, uint32_t precision, RoundingMode mode
+) {
+	return addSigned(a, b, false, precision, mode);
+}
+
+BigFloat BigFloat::sub(
+	const BigFloat &a, const BigFloat &b, uint32_t precision, RoundingMode mode
+) {
+	return addSigned(a, b, true, precision, mode);
+}
+
+BigFloat BigFloat::mul(
+	const BigFloat &a, const BigFloat &b, uint32_t precision, RoundingMode mode
+) {
+	if (a.isZero() || b.isZero())
+		return roundToPrecision(nullptr, 0, 0, false, false, precision, mode);
+	// The exact product is at most `an + bn` limbs, the mantissas only
+	// hold significant bits
+	kernels::Limbs product(a.mantissa.size() + b.mantissa.size());
+	kernels::mul(
+		product.data(), a.mantissa.data(), a.mantissa.size(),
+		b.mantissa.data(), b.mantissa.size()
+	);
+	return roundToPrecision(
+		product.data(), product.size(), a.exponent + b.exponent,
+		a.sign != b.sign, false, precision, mode
+	);
+}
+
+BigFloat BigFloat::div(
+	const BigFloat &a, const BigFloat &b, uint32_t precision, RoundingMode mode
+) {
+	if (b.isZero()) throw std::invalid_argument("Division by zero");
+	if (a.isZero())
+		return roundToPrecision(nullptr, 0, 0, false, false, precision, mode);
+
+	// Shifting the numerator by `shift` bits gives a quotient of at least
+	// precision + 2 bits, the remainder decides the sticky bit
+	int64_t aBits = bitLength(a.mantissa.data(), a.mantissa.size());
+	int64_t bBits = bitLength(b.mantissa.data(), b.mantissa.size());
+	uint64_t shift = std::max<int64_t>(0, precision + 2 + bBits - aBits);
+	kernels::Limbs numerator(shift / 32 + a.mantissa.size() + 1, 0);
+	place(numerator.data(), a.mantissa.data(), a.mantissa.size(), shift);
+	size_t numeratorSize =
+		kernels::normalizedSize(numerator.data(), numerator.size());
+	size_t divisorSize = b.mantissa.size();
+
+	kernels::Limbs quotient(numeratorSize - divisorSize + 1);
+	kernels::Limbs remainder(divisorSize);
+	kernels::divmod(
+		quotient.data(), remainder.data(), numerator.data(), numeratorSize,
+		b.mantissa.data(), divisorSize
+	);
+	bool sticky = kernels::normalizedSize(remainder.data(), divisorSize) != 0;
+	return roundToPrecision(
+		quotient.data(), quotient.size(),
+		a.exponent - static_cast<int64_t>(shift) - b.exponent,
+		a.sign != b.sign, sticky, precision, mode
+	);
+}
+
+BigFloat BigFloat::abs(void) const {
+	BigFloat result = *this;
+	result.sign = 1;
+	return result;
+}
+
+// *CONVERSION*
+
+LongNumber BigFloat::toLongNumber(uint32_t fractionBits, RoundingMode mode)
+	const {
+	// Bits below 2^(-fractionBits) are rounded off
+	int64_t cut = -static_cast<int64_t>(fractionBits);
+	uint64_t drop = exponent < cut ? cut - exponent : 0;
+	BigFloat value = rounded(
+		mantissa.data(), mantissa.size(), exponent, sign < 0, false, drop,
+		precision, mode
+	);
+	if (value.isZero()) return LongNumber(0, fractionBits);
+
+	// The lowest chunk of a `LongNumber` holds 2^(-32 * fractionChunks)
+	int64_t fractionChunks = (static_cast<int64_t>(fractionBits) + 31) / 32;
+	uint64_t shift = value.exponent + 32 * fractionChunks;
+	kernels::Limbs limbs(shift / 32 + value.mantissa.size() + 1, 0);
+	place(limbs.data(), value.mantissa.data(), value.mantissa.size(), shift);
+	return LongNumber::fromLimbs(limbs, value.sign < 0, fractionBits);
+}
+
+const std::string BigFloat::toString(uint32_t digitsAfterDecimal) const {
+	// 32 spare bits below the last digit
+	uint32_t fractionBits = std::ceil(digitsAfterDecimal * std::log2(10.0L));
+	return toLongNumber(fractionBits + 32, RoundingMode::TowardZero)
+		.toString(digitsAfterDecimal);
+}
+
+// *OPERATORS*
+
+std::strong_ordering BigFloat::compareAbs(const BigFloat &other) const {
+	if (isZero() || other.isZero()) return other.isZero() <=> isZero();
+	if (topBit() != other.topBit()) return topBit() <=> other.topBit();
+	// Same top bit, the mantissas are compared aligned at the lower exponent
+	int64_t bottom = std::min(exponent, other.exponent);
+	size_t n = (topBit() - bottom + 31) / 32;
+	kernels::Limbs x(n, 0), y(n, 0);
+	place(x.data(), mantissa.data(), mantissa.size(), exponent - bottom);
+	place(
+		y.data(), other.mantissa.data(), other.mantissa.size(),
+		other.exponent - bottom
+	);
+	return kernels::compareN(x.data(), y.data(), n) <=> 0;
+}
+
+std::strong_ordering BigFloat::operator<=>(const BigFloat &other) const {
+	int signThis = isZero() ? 0 : sign;
+	int signOther = other.isZero() ? 0 : other.sign;
+	if (signThis != signOther) return signThis <=> signOther;
+
+	std::strong_ordering order = compareAbs(other);
+	return (sign == 1) ? order : 0 <=> order;
+}
+
+// Canonical mantissas make equal values have equal representations
+bool BigFloat::operator==(const BigFloat &other) const {
+	return sign == other.sign && exponent == other.exponent &&
+		   std::equal(
+			   mantissa.begin(), mantissa.end(), other.mantissa.begin(),
+			   other.mantissa.end()
+		   );
+}
+
+BigFloat &BigFloat::operator<<=(int64_t shift) {
+	if (!isZero()) exponent += shift;
+	return *this;
+}
+
+BigFloat &BigFloat::operator>>=(int64_t shift) {
+	if (!isZero()) exponent -= shift;
+	return *this;
+}
+
+BigFloat BigFloat::operator+(const BigFloat &other) const {
+	return add(*this, other, std::max(precision, other.precision));
+}
+
+BigFloat BigFloat::operator-(const BigFloat &other) const {
+	return sub(*this, other, std::max(precision, other.precision));
+}
+
+BigFloat BigFloat::operator*(const BigFloat &other) const {
+	return mul(*this, other, std::max(precision, other.precision));
+}
+
+BigFloat BigFloat::operator/(const BigFloat &other) const {
+	return div(*this, other, std::max(precision, other.precision));
+}
+
+BigFloat &BigFloat::operator+=(const BigFloat &other) {
+	*this = *this + other;
+	return *this;
+}
+
+BigFloat &BigFloat::operator-=(const BigFloat &other) {
+	*this = *this - other;
+	return *this;
+}
+
+BigFloat &BigFloat::operator*=(const BigFloat &other) {
+	*this = *this * other;
+	return *this;
+}
+
+BigFloat &BigFloat::operator/=(const BigFloat &other) {
+	*this = *this / other;
+	return *this;
+}
+
+BigFloat BigFloat::operator-() const {
+	BigFloat result = *this;
+	if (!result.isZero()) result.sign = -sign;
+	return result;
+}
+
+BigFloat operator<<(BigFloat lhs, int64_t shift) {
+	lhs <<= shift;
+	return lhs;
+}
+
+BigFloat operator>>(BigFloat lhs, int64_t shift) {
+	lhs >>= shift;
+	return lhs;
+}
+} // namespace LongArithm
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "LongArithm.hpp"
+#include "SmallVector.hpp"
+
+namespace LongArithm {
+// IEEE 754 rounding direction attributes
+enum class RoundingMode {
+	NearestEven, // roundTiesToEven
+	NearestAway, // roundTiesToAway
+	TowardZero,
+	TowardPositive,
+	TowardNegative
+};
+
+// Binary floating point number `sign * mantissa * 2^exponent`
+// Unlike `LongNumber` there is no fixed fraction: every result is rounded
+// to a precision in significant bits, so very large, very small or mixed
+// magnitudes cost only the limbs of their significant bits
+// The mantissa is kept odd (zero low bits go to the exponent), zero has
+// no limbs. Operations run on the same kernels as `LongNumber`
+class BigFloat {
+  private:
+	// Odd, little endian, without leading zero limbs
+	SmallVector<uint32_t, 8> mantissa;
+	int64_t exponent = 0;
+	short sign = 1;
+	uint32_t precision = defaultPrecision;
+
+	bool isZero(void) const;
+	// Position above the most significant bit, 2^(topBit - 1) <= |x|
+	int64_t topBit(void) const;
+	// Drops zero limbs and bits on both ends of the mantissa
+	void canonicalize(void);
+
+	// Rounds `m * 2^exponent` with the `drop` lowest bits cut off
+	// `sticky` stands for nonzero bits already cut off below `m`
+	static BigFloat rounded(
+		const uint32_t *m, size_t n, int64_t exponent, bool negative,
+		bool sticky, uint64_t drop, uint32_t precision, RoundingMode mode
+	);
+	// Same with as many bits cut off as needed to fit into `precision`
+	// Throws `std::invalid_argument` if `precision` is 0
+	static BigFloat roundToPrecision(
+		const uint32_t *m, size_t n, int64_t exponent, bool negative,
+		bool sticky, uint32_t precision, RoundingMode mode
+	);
+	// a + b or a - b
+	static BigFloat addSigned(
+		const BigFloat &a, const BigFloat &b, bool subtract, uint32_t precision,
+		RoundingMode mode
+	);
+
+  public:
+	static constexpr uint32_t defaultPrecision = 96;
+
+	BigFloat() = default;
+	// Throws `std::invalid_argument` for infinities and NaN
+	BigFloat(
+		long double value, uint32_t precision = defaultPrecision,
+		RoundingMode mode = RoundingMode::NearestEven
+	);
+	// Bits of `value` below its precision are ignored
+	explicit BigFloat(
+		const LongNumber &value, uint32_t precision = defaultPrecision,
+		RoundingMode mode = RoundingMode::NearestEven
+	);
+
+	uint32_t getPrecision(void) const;
+	// Rounds the mantissa to `precision` bits
+	void setPrecision(
+		uint32_t precision, RoundingMode mode = RoundingMode::NearestEven
+	);
+	BigFloat withPrecision(
+		uint32_t precision, RoundingMode mode = RoundingMode::NearestEven
+	) const;
+	short getSign(void) const;
+	int64_t getExponent(void) const;
+	std::span<const uint32_t> getMantissa(void) const;
+
+	// Correctly rounded results: the exact value rounded to `precision`
+	// significant bits in the direction of `mode`
+	static BigFloat
+	add(const BigFloat &a, const BigFloat &b, uint32_t precision,
+		RoundingMode mode = RoundingMode::NearestEven);
+	static BigFloat
+	sub(const BigFloat &a, const BigFloat &b, uint32_t precision,
+		RoundingMode mode = RoundingMode::NearestEven);
+	static BigFloat
+	mul(const BigFloat &a, const BigFloat &b, uint32_t precision,
+		RoundingMode mode = RoundingMode::NearestEven);
+	// Throws `std::invalid_argument` if `b` is 0
+	static BigFloat
+	div(const BigFloat &a, const BigFloat &b, uint32_t precision,
+		RoundingMode mode = RoundingMode::NearestEven);
+
+	BigFloat abs(void) const;
+	// Rounds to a multiple of 2^(-fractionBits)
+	LongNumber toLongNumber(
+		uint32_t fractionBits = 96,
+		RoundingMode mode = RoundingMode::NearestEven
+	) const;
+	// Decimal representation, the digits are truncated
+	const std::string toString(uint32_t digitsAfterDecimal = 8) const;
+
+	std::strong_ordering compareAbs(const BigFloat &other) const;
+	std::strong_ordering operator<=>(const BigFloat &other) const;
+	bool operator==(const BigFloat &other) const;
+
+	// Multiply and divide by powers of 2, only the exponent changes
+	BigFloat &operator<<=(int64_t shift);
+	BigFloat &operator>>=(int64_t shift);
+
+	// Rounded to the nearest (ties to even) with the maximum precision of
+	// the two operands
+	BigFloat operator+(const BigFloat &other) const;
+	BigFloat operator-(const BigFloat &other) const;
+	BigFloat operator*(const BigFloat &other) const;
+	BigFloat operator/(const BigFloat &other) const;
+
+	BigFloat &operator+=(const BigFloat &other);
+	BigFloat &operator-=(const BigFloat &other);
+	BigFloat &operator*=(const BigFloat &other);
+	BigFloat &operator/=(const BigFloat &other);
+
+	BigFloat operator-() const;
+};
+BigFloat operator<<(BigFloat lhs, int64_t shift);
+BigFloat operator>>(BigFloat lhs, int64_t shift);
+} // namespace LongArithm
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+#include "LimbPool.hpp"
+#include "Stats.hpp"
+
+namespace LongArithm {
+namespace {
+// Stored in front of every block
+struct alignas(16) BlockHeader {
+	uint64_t owner; // `ArenaScope::id`, 0 if the block bypasses the pool
+	size_t bytes;	// Usable size
+};
+
+thread_local ArenaScope *current = nullptr;
+std::atomic<uint64_t> nextId = 1;
+
+// Live scopes by id, looked up when a block is freed outside of its scope
+std::mutex registryMutex;
+std::unordered_map<uint64_t, ArenaScope *> registry;
+
+constexpr size_t minBlock = 64;
+
+// Index of the smallest class that fits `bytes`, rounds `bytes` up to it
+// Class sizes are 64 and 2^k * (1 + q / 4) for k >= 6 and q = 1..4 so
+// at most a quarter of a block is wasted
+size_t sizeClass(size_t &bytes) {
+	if (bytes <= minBlock) {
+		bytes = minBlock;
+		return 0;
+	}
+	// 2^k < bytes <= 2^(k + 1)
+	int k = std::bit_width(bytes - 1) - 1;
+	size_t base = size_t(1) << k, step = base / 4;
+	size_t quarter = (bytes - base + step - 1) / step;
+	bytes = base + quarter * step;
+	return 4 * (k - 6) + quarter;
+}
+
+void *allocateBlock(uint64_t owner, size_t bytes) {
+	auto *header = static_cast<BlockHeader *>(
+		::operator new(sizeof(BlockHeader) + bytes)
+	);
+	header->owner = owner;
+	header->bytes = bytes;
+	return header + 1;
+}
+} // namespace
+
+ArenaScope::ArenaScope() : id(nextId++), previous(current) {
+	current = this;
+	std::lock_guard lock(registryMutex);
+	registry[id] = this;
+}
+
+ArenaScope::~ArenaScope() {
+	{
+		std::lock_guard lock(registryMutex);
+		registry.erase(id);
+	}
+	for (void *block : freeLists) {
+		while (block != nullptr) {
+			void *next = *static_cast<void **>(block);
+			::operator delete(static_cast<BlockHeader *>(block) - 1);
+			block = next;
+		}
+	}
+	current = previous;
+}
+
+bool ArenaScope::isActive(void) { return current != nullptr; }
+
+PoolStatistics ArenaScope::statistics(void) const {
+	PoolStatistics result = stats;
+	result.bytes -= releasedBytes.load(std::memory_order_relaxed);
+	return result;
+}
+
+void *poolAllocate(size_t &bytes) {
+	STATS_COUNT(Allocation, bytes / sizeof(uint32_t));
+	ArenaScope *scope = current;
+	if (scope == nullptr) return allocateBlock(0, bytes);
+	size_t rounded = bytes;
+	size_t index = sizeClass(rounded);
+	if (index >= ArenaScope::classCount) return allocateBlock(0, bytes);
+	bytes = rounded;
+
+	void *&head = scope->freeLists[index];
+	if (head != nullptr) {
+		void *block = head;
+		head = *static_cast<void **>(block);
+		scope->stats.hits++;
+		return block;
+	}
+	scope->stats.misses++;
+	scope->stats.bytes += bytes;
+	size_t released = scope->releasedBytes.load(std::memory_order_relaxed);
+	scope->stats.peakBytes =
+		std::max(scope->stats.peakBytes, scope->stats.bytes - released);
+	return allocateBlock(scope->id, bytes);
+}
+
+void poolDeallocate(void *block) {
+	if (block == nullptr) return;
+	auto *header = static_cast<BlockHeader *>(block) - 1;
+	ArenaScope *scope = current;
+	// Blocks of other scopes or threads go to the heap, their owner (if
+	// still alive) stops counting them
+	if (scope == nullptr || header->owner != scope->id) {
+		if (header->owner != 0) {
+			std::lock_guard lock(registryMutex);
+			auto owner = registry.find(header->owner);
+			if (owner != registry.end())
+				owner->second->releasedBytes.fetch_add(
+					header->bytes, std::memory_order_relaxed
+				);
+		}
+		::operator delete(header);
+		return;
+	}
+	size_t bytes = header->bytes;
+	size_t index = sizeClass(bytes);
+	*static_cast<void **>(block) = scope->freeLists[index];
+	scope->freeLists[index] = block;
+}
+} // namespace LongArithm
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace LongArithm {
+// Counters of a single `ArenaScope`
+struct PoolStatistics {
+	size_t hits = 0;	// Blocks handed out again from the pool
+	size_t misses = 0;	// Blocks requested from the heap
+	size_t bytes = 0;	// Held by the pool (in use and cached)
+	size_t peakBytes = 0;
+};
+
+// While alive, heap storage of `LongNumber` and of kernel temporaries
+// created in the current thread is taken from a size-class pool
+// Freed blocks are cached and handed out again, so loops creating numbers
+// of similar sizes stop calling `new`
+// Scopes can be nested, the innermost one is used. Cached blocks are freed
+// with the scope, blocks still in use stay valid and go to the heap later
+class ArenaScope {
+  public:
+	ArenaScope();
+	~ArenaScope();
+	ArenaScope(const ArenaScope &) = delete;
+	ArenaScope &operator=(const ArenaScope &) = delete;
+
+	// Blocks freed by other scopes or threads are no longer counted
+	PoolStatistics statistics(void) const;
+	// True if the current thread has an `ArenaScope`
+	static bool isActive(void);
+
+  private:
+	// 64 bytes and up, 4 classes per power of 2 (see `sizeClass`)
+	static constexpr size_t classCount = 4 * 40 + 1;
+
+	uint64_t id;
+	ArenaScope *previous;
+	// Singly linked lists threaded through the cached blocks
+	std::array<void *, classCount> freeLists{};
+	PoolStatistics stats;
+	// Bytes of blocks freed outside of this scope, subtracted from `stats`
+	std::atomic<size_t> releasedBytes = 0;
+
+	friend void *poolAllocate(size_t &bytes);
+	friend void poolDeallocate(void *block);
+};
+
+// Returns a block of at least `bytes` bytes aligned to 16
+// `bytes` is updated to the usable size of the block
+void *poolAllocate(size_t &bytes);
+// Releases a block returned by `poolAllocate`, accepts nullptr
+void poolDeallocate(void *block);
+
+// Allocator for standard containers, see `kernels::Limbs`
+template <typename T> struct PoolAllocator {
+	using value_type = T;
+
+	PoolAllocator() = default;
+	template <typename U> PoolAllocator(const PoolAllocator<U> &) {}
+
+	T *allocate(size_t n) {
+		size_t bytes = n * sizeof(T);
+		return static_cast<T *>(poolAllocate(bytes));
+	}
+	void deallocate(T *block, size_t) { poolDeallocate(block); }
+
+	template <typename U> bool operator==(const PoolAllocator<U> &) const {
+		return true;
+	}
+};
+} // namespace LongArithm
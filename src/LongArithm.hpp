@@ -1,17 +1,55 @@
 #pragma once
 
 #include <compare>
+#include <concepts>
 #include <cstdint>
+#include <functional>
 #include <iostream>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "SmallVector.hpp"
+
 #define digitsPerChunk 32
 
 namespace LongArithm {
+// Operand sizes (in chunks) from which `operator*` switches algorithms
+// Smaller operands use the schoolbook O(n * m) multiplication
+struct MultiplicationThresholds {
+	size_t karatsuba = 64;
+	size_t toom3 = 160;
+	size_t ntt = 2048;
+};
+void setMultiplicationThresholds(const MultiplicationThresholds &thresholds);
+MultiplicationThresholds getMultiplicationThresholds(void);
+// Upper bound on the number of threads used by large multiplications
+// and `pi::calculatePi`. Defaults to 1 (single threaded)
+void setThreadCount(unsigned threads);
+unsigned getThreadCount(void);
+// Instruction set extensions used by the kernels, every tier includes the
+// previous ones: BMI2 needs BMI2 and ADX (mulx, adcx, adox), AVX2 adds
+// AVX2 and AVX512 adds AVX-512F. Only `Generic` exists outside of x86-64
+enum class CpuTier { Generic, BMI2, AVX2, AVX512 };
+// Best tier the CPU supports, detected once with cpuid
+CpuTier detectCpuTier(void);
+// Switches the kernels to `tier`, the detected one is used by default
+// Must not be called while other threads run operations
+// Throws `std::invalid_argument` if the CPU does not support `tier`
+void setCpuTier(CpuTier tier);
+CpuTier getCpuTier(void);
+// "generic", "bmi2", "avx2" or "avx512"
+std::string_view cpuTierName(CpuTier tier);
+std::optional<CpuTier> parseCpuTier(std::string_view name);
+// Receives consecutive parts of a decimal representation
+using DigitSink = std::function<void(std::string_view block)>;
+
 class LongNumber {
   private:
-	std::vector<uint32_t> chunks;
+	// Values up to 256 bits (including fraction) do not allocate
+	SmallVector<uint32_t, 8> chunks;
 	short sign;
 	uint32_t fractionBits;
 
@@ -20,6 +58,35 @@ class LongNumber {
 
 	void allocateFraction(void);
 	void truncateWholePart(void);
+	// Both of the above, zero gets a positive sign
+	void normalize(void);
+
+	bool isZero(void) const;
+	// |this| += |other| and |this| -= |other| in place
+	// The result gets the maximum precision of the two numbers
+	void addMagnitude(const LongNumber &other);
+	void subMagnitude(const LongNumber &other);
+
+	// Arithmetic with an integer given by its absolute value and sign
+	// Runs a single pass over `chunks`, precision stays the same
+	void addInteger(uint64_t value, bool negative);
+	void mulInteger(uint64_t value, bool negative);
+	void divInteger(uint64_t value, bool negative);
+
+	template <std::integral T> static uint64_t magnitude(T value) {
+		if constexpr (std::is_signed_v<T>) {
+			if (value < 0) return 0 - static_cast<uint64_t>(value);
+		}
+		return static_cast<uint64_t>(value);
+	}
+	template <std::integral T> static bool isNegative(T value) {
+		if constexpr (std::is_signed_v<T>) return value < 0;
+		return false;
+	}
+
+	long double toLongDouble(void) const;
+	LongNumber inverseRoot(uint32_t n, uint32_t precision) const;
+	static LongNumber integerRoot(const LongNumber &value, uint32_t n);
 
 	inline char digitToChar(const int d) const;
 	inline u_int32_t getFractionChunks(void) const;
@@ -32,23 +99,67 @@ class LongNumber {
 	LongNumber();
 	LongNumber(long double input, uint32_t fractionBits = 96);
 	LongNumber(const std::string input, uint32_t _fractionBits = 96);
+	// Parses a decimal string `[+-]digits[.digits][(e|E)[+-]digits]`
+	// Fraction is rounded to the nearest multiple of 2^(-fractionBits)
+	// Takes O(M(|exponent|)), except for values rounding to 0 which return
+	// right away. Throws `std::out_of_range` if the whole part would need
+	// more than 2^32 bits
+	static LongNumber
+	fromDecimalString(const std::string &input, uint32_t fractionBits = 96);
 
 	LongNumber(const LongNumber &other) = default;
-	LongNumber &operator=(const LongNumber other);
+	LongNumber(LongNumber &&other) noexcept = default;
+	LongNumber &operator=(const LongNumber &other) = default;
+	LongNumber &operator=(LongNumber &&other) noexcept = default;
 	~LongNumber() = default;
 
 	void setPrecision(uint32_t precision);
 	LongNumber withPrecision(uint32_t precision) const;
 	uint32_t getChunk(uint32_t index) const;
+	uint32_t getPrecision(void) const;
+	// 1 or -1, zero is positive
+	short getSign(void) const;
+	// All chunks as stored, little endian. Unlike `getChunk` the bits of
+	// the lowest chunk below precision are not masked
+	std::span<const uint32_t> getChunks(void) const;
 
 	LongNumber abs(void) const;
+	// Same as `*this * *this`, computes about half of the partial products
+	LongNumber square(void) const;
 	LongNumber pow(uint32_t power) const;
 	LongNumber sqrt(void) const;
+	// Returns the n-th root truncated to the precision of `*this`
+	// Throws `std::invalid_argument` for n = 0 and even roots of negatives
+	LongNumber nthRoot(uint32_t n) const;
 
 	void printChunks(void) const;
 	const std::string toBinaryString(void) const;
 	const std::string toString(uint32_t digitsAfterDecimal = 8) const;
-
+	// Writes the same characters as `toString` in blocks of at most
+	// `blockDigits` digits instead of building the whole string
+	void writeString(
+		const DigitSink &sink, uint32_t digitsAfterDecimal = 8,
+		size_t blockDigits = 10000
+	) const;
+	void writeString(
+		std::ostream &out, uint32_t digitsAfterDecimal = 8,
+		size_t blockDigits = 10000
+	) const;
+
+	// Little endian binary format: "LNUM", format version (u32),
+	// fractionBits (u32), sign (1 or -1, i32), limb count (u64), limbs
+	void serialize(std::ostream &out) const;
+	// Throws `std::runtime_error` if `in` does not hold a serialized number
+	static LongNumber deserialize(std::istream &in);
+	// Copies little endian limbs, the lowest `ceil(fractionBits / 32)` of
+	// them hold the fraction
+	static LongNumber fromLimbs(
+		std::span<const uint32_t> limbs, bool negative, uint32_t fractionBits
+	);
+
+	// Compares absolute values, bits below precision are ignored
+	// Does not allocate, chunks are compared in place from the top
+	std::strong_ordering compareAbs(const LongNumber &other) const;
 	std::strong_ordering operator<=>(const LongNumber &other) const;
 	bool operator==(const LongNumber &other) const;
 
@@ -65,9 +176,62 @@ class LongNumber {
 	LongNumber &operator*=(const LongNumber &other);
 	LongNumber &operator/=(const LongNumber &other);
 
-	LongNumber operator-() const;
+	// Integer operands do not get converted to `LongNumber`
+	// The result keeps the precision of `*this`
+	template <std::integral T> LongNumber &operator+=(T value) {
+		addInteger(magnitude(value), isNegative(value));
+		return *this;
+	}
+	template <std::integral T> LongNumber &operator-=(T value) {
+		addInteger(magnitude(value), !isNegative(value));
+		return *this;
+	}
+	template <std::integral T> LongNumber &operator*=(T value) {
+		mulInteger(magnitude(value), isNegative(value));
+		return *this;
+	}
+	// Throws `std::invalid_argument` if `value` is 0
+	template <std::integral T> LongNumber &operator/=(T value) {
+		divInteger(magnitude(value), isNegative(value));
+		return *this;
+	}
+
+	LongNumber operator-() const &;
+	LongNumber operator-() &&;
 };
 LongNumber operator""_longnum(long double value);
+// Overloads taking an expiring operand reuse its chunks for the result
+LongNumber operator+(LongNumber &&lhs, const LongNumber &rhs);
+LongNumber operator+(const LongNumber &lhs, LongNumber &&rhs);
+LongNumber operator+(LongNumber &&lhs, LongNumber &&rhs);
+LongNumber operator-(LongNumber &&lhs, const LongNumber &rhs);
+LongNumber operator-(const LongNumber &lhs, LongNumber &&rhs);
+LongNumber operator-(LongNumber &&lhs, LongNumber &&rhs);
+
+template <std::integral T> LongNumber operator+(LongNumber lhs, T rhs) {
+	lhs += rhs;
+	return lhs;
+}
+template <std::integral T> LongNumber operator+(T lhs, LongNumber rhs) {
+	rhs += lhs;
+	return rhs;
+}
+template <std::integral T> LongNumber operator-(LongNumber lhs, T rhs) {
+	lhs -= rhs;
+	return lhs;
+}
+template <std::integral T> LongNumber operator*(LongNumber lhs, T rhs) {
+	lhs *= rhs;
+	return lhs;
+}
+template <std::integral T> LongNumber operator*(T lhs, LongNumber rhs) {
+	rhs *= lhs;
+	return rhs;
+}
+template <std::integral T> LongNumber operator/(LongNumber lhs, T rhs) {
+	lhs /= rhs;
+	return lhs;
+}
 LongNumber operator<<(LongNumber lhs, int shift);
 LongNumber operator>>(LongNumber lhs, int shift);
 // std::ostream &operator<<(std::ostream &os, const LongNumber &number);
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cmath>
 #include <compare>
@@ -9,6 +10,9 @@
 #include <sstream>
 
 #include "LongArithm.hpp"
+#include "Serialization.hpp"
+#include "Stats.hpp"
+#include "kernels/kernels.hpp"
 
 namespace LongArithm {
 
@@ -47,6 +51,12 @@ void LongNumber::truncateWholePart(void) {
 		chunks.pop_back();
 }
 
+void LongNumber::normalize(void) {
+	allocateFraction();
+	truncateWholePart();
+	if (isZero()) sign = 1;
+}
+
 // *CONVERSION UTILS*
 
 // Converts digit to corresponding chat by adding `'0'`
@@ -65,9 +75,9 @@ void LongNumber::convertBinaryString(const std::string &input) {
 	// From the least significant to the most significant
 	long long i = input.size() - 1;
 	long long j = 0;
-	char c;
 	uint32_t curChunk = 0;
-	while ((c = input[i]), i >= 0) {
+	while (i >= 0) {
+		char c = input[i];
 		int indexInChunk = j % digitsPerChunk;
 		if (indexInChunk % digitsPerChunk == 0 && j != 0) {
 			chunks.push_back(curChunk);
@@ -137,6 +147,127 @@ void LongNumber::fromBinaryString(
 	truncateWholePart();
 }
 
+// Parses decimal string, see declaration for the accepted format
+// Throws `std::invalid_argument` if the string does not match it
+// Throws `std::out_of_range` if the exponent is too large
+LongNumber LongNumber::fromDecimalString(
+	const std::string &input, uint32_t _fractionBits
+) {
+	STATS_TIME(FromString, input.size() / 9 + 1);
+	size_t pos = 0;
+	bool negative = false;
+	if (pos < input.size() && (input[pos] == '-' || input[pos] == '+'))
+		negative = input[pos++] == '-';
+
+	// Mantissa digits without the decimal point
+	std::string digits;
+	int64_t fractionDigits = 0;
+	bool seenDot = false;
+	for (; pos < input.size(); pos++) {
+		char c = input[pos];
+		if (c == '.' && !seenDot) {
+			seenDot = true;
+		} else if (c >= '0' && c <= '9') {
+			digits += c;
+			fractionDigits += seenDot;
+		} else {
+			break;
+		}
+	}
+	if (digits.empty())
+		throw std::invalid_argument("Decimal string must contain digits");
+
+	int64_t exponent = 0;
+	if (pos < input.size() && (input[pos] == 'e' || input[pos] == 'E')) {
+		pos++;
+		bool negativeExponent = false;
+		if (pos < input.size() && (input[pos] == '-' || input[pos] == '+'))
+			negativeExponent = input[pos++] == '-';
+		if (pos == input.size())
+			throw std::invalid_argument("Exponent must contain digits");
+		// Saturates, the magnitude checks below handle large exponents
+		for (; pos < input.size() && input[pos] >= '0' && input[pos] <= '9';
+			 pos++) {
+			if (exponent < std::numeric_limits<int32_t>::max())
+				exponent = exponent * 10 + (input[pos] - '0');
+		}
+		if (negativeExponent) exponent = -exponent;
+	}
+	if (pos != input.size())
+		throw std::invalid_argument(
+			"Invalid character found. Expected [0-9], '.' or exponent"
+		);
+
+	LongNumber result(0.0L, _fractionBits);
+	uint32_t fractionChunks = result.getFractionChunks();
+	// value = mantissa * 10^scale < 10^magnitude
+	int64_t scale = exponent - fractionDigits;
+	int64_t magnitude = scale + static_cast<int64_t>(digits.size());
+	// Values below 2^(-fractionBits - 1) round to 0, without building
+	// 10^(-scale). One spare decimal digit covers the rounding of log10
+	if (magnitude < -(_fractionBits + 1.0L) * std::log10(2.0L) - 1)
+		return result;
+	kernels::Limbs mantissa =
+		kernels::fromDecimal(digits.data(), digits.size());
+	if (mantissa.empty()) return result;
+	// Bits of the whole part are indexed by `uint32_t`
+	if (magnitude * std::log2(10.0L) > std::numeric_limits<uint32_t>::max())
+		throw std::out_of_range("Exponent is too large");
+
+	kernels::Limbs value;
+	if (scale >= 0) {
+		kernels::Limbs power = kernels::powerOfTen(scale);
+		// The product goes right above the zero fraction chunks
+		value.resize(fractionChunks + mantissa.size() + power.size());
+		kernels::mul(
+			value.data() + fractionChunks, mantissa.data(), mantissa.size(),
+			power.data(), power.size()
+		);
+	} else {
+		// round(mantissa * 2^fractionBits / 10^(-scale))
+		kernels::Limbs power = kernels::powerOfTen(-scale);
+		kernels::Limbs numerator(_fractionBits / digitsPerChunk, 0);
+		numerator.insert(numerator.end(), mantissa.begin(), mantissa.end());
+		numerator.push_back(0);
+		numerator.back() = kernels::shiftLeft(
+			numerator.data() + _fractionBits / digitsPerChunk,
+			numerator.data() + _fractionBits / digitsPerChunk,
+			mantissa.size(), _fractionBits % digitsPerChunk
+		);
+		kernels::normalize(numerator);
+
+		kernels::Limbs remainder(power.size());
+		value.resize(
+			std::max(numerator.size(), power.size()) - power.size() + 2, 0
+		);
+		kernels::divmod(
+			value.data(), remainder.data(), numerator.data(),
+			numerator.size(), power.data(), power.size()
+		);
+		// Round half to even, compare 2 * remainder with the divisor
+		remainder.push_back(kernels::shiftLeft(
+			remainder.data(), remainder.data(), power.size(), 1
+		));
+		int cmp = kernels::compare(
+			remainder.data(), remainder.size(), power.data(), power.size()
+		);
+		if (cmp > 0 || (cmp == 0 && (value[0] & 1))) {
+			const uint32_t one = 1;
+			kernels::addInPlace(value.data(), value.size(), &one, 1);
+		}
+
+		// Value is scaled by 2^fractionBits, chunks by 2^(32 * chunks)
+		uint32_t shift = fractionChunks * digitsPerChunk - _fractionBits;
+		value.push_back(0);
+		kernels::shiftLeft(value.data(), value.data(), value.size(), shift);
+	}
+	result.chunks.assign(value.begin(), value.end());
+	result.allocateFraction();
+	result.truncateWholePart();
+	if (negative && result != 0) result.sign = -1;
+	return result;
+}
+
 // *USER DEFINED LITERALS*
 
 LongNumber operator""_longnum(long double number) { return LongNumber(number); }
@@ -183,7 +314,8 @@ LongNumber::LongNumber(const std::string input, uint32_t _fractionBits) {
 // *PRECISION HANDLERS*
 
 // Updates `fractionBits`
-// Resizes `chunks` to match new precision
+// Resizes `chunks` to match new precision. Chunks are added or dropped at
+// the front of the `SmallVector` window, the others stay in place
 void LongNumber::setPrecision(uint32_t _precision) {
 	uint32_t oldFracChunks = getFractionChunks();
 	fractionBits = _precision;
@@ -218,6 +350,14 @@ uint32_t LongNumber::getChunk(uint32_t index) const {
 	return chunks[index] & (mask << shift);
 }
 
+uint32_t LongNumber::getPrecision(void) const { return fractionBits; }
+
+short LongNumber::getSign(void) const { return sign; }
+
+std::span<const uint32_t> LongNumber::getChunks(void) const {
+	return std::span<const uint32_t>(chunks.data(), chunks.size());
+}
+
 // *MATH UTILS*
 LongNumber LongNumber::abs(void) const {
 	LongNumber result = *this;
@@ -225,7 +365,11 @@ LongNumber LongNumber::abs(void) const {
 	return result;
 }
 
+// `operator*` recognizes equal operands and calls the squaring kernels
+LongNumber LongNumber::square(void) const { return *this * *this; }
+
 LongNumber LongNumber::pow(uint32_t power) const {
+	STATS_TIME(Power, chunks.size());
 	if (power == 1) return *this;
 	// Result has the same precision
 	LongNumber result(1, fractionBits);
@@ -235,34 +379,107 @@ LongNumber LongNumber::pow(uint32_t power) const {
 	// Minimize iterations by leveraging the closest power of 2
 	while (power) {
 		if (power & 1) result *= accumulator;
-		accumulator *= accumulator;
 		power >>= 1;
+		if (power) accumulator = accumulator.square();
 	}
 	return result;
 }
 
-// Newton-Raphson method for calculating square root
 LongNumber LongNumber::sqrt(void) const {
 	if (sign == -1)
 		throw std::invalid_argument(
 			"Failed to calculate square root: number is negative"
 		);
-	// If integer make room for fraction part to increase accuracy
-	LongNumber normalisedThis = *this;
-	if (normalisedThis.fractionBits < 96) normalisedThis.setPrecision(96);
+	return nthRoot(2);
+}
+
+LongNumber LongNumber::nthRoot(uint32_t n) const {
+	STATS_TIME(Root, chunks.size());
+	if (n == 0)
+		throw std::invalid_argument("Failed to calculate root: degree is 0");
+	if (sign == -1 && n % 2 == 0)
+		throw std::invalid_argument(
+			"Failed to calculate root: even root of a negative number"
+		);
+	if (n == 1) return *this;
+
+	// Make room for fraction part to increase accuracy (same as division)
+	uint32_t workChunks =
+		(std::max(fractionBits, 96U) + digitsPerChunk - 1) / digitsPerChunk;
+	uint32_t workBits = workChunks * digitsPerChunk;
+	// floor(|x| * 2^(n * workBits)) is an integer, its root is the result
+	// scaled by 2^workBits
+	LongNumber scaled = abs();
+	scaled <<= n * workBits;
+	scaled.setPrecision(0);
+
+	LongNumber root = integerRoot(scaled, n);
+	root.fractionBits = workBits;
+	root.allocateFraction();
+	if (!root.isZero()) root.sign = sign;
+	root.setPrecision(fractionBits);
+	root.truncateWholePart();
+	return root;
+}
 
-	LongNumber guess = LongNumber(1.0L, normalisedThis.fractionBits);
-	LongNumber prevGuess;
+// Value of the 3 most significant chunks, enough for a long double
+long double LongNumber::toLongDouble(void) const {
+	long double result = 0;
+	int fractionChunks = getFractionChunks();
+	// Three leading nonzero chunks cover the 64 bit mantissa
+	size_t size = kernels::normalizedSize(chunks.data(), chunks.size());
+	for (size_t i = size; i-- > 0 && size - i <= 3;)
+		result += std::ldexp(
+			static_cast<long double>(chunks[i]),
+			digitsPerChunk * (static_cast<int>(i) - fractionChunks)
+		);
+	return sign * result;
+}
 
-	while (guess != prevGuess) {
-		prevGuess = guess;
-		guess += normalisedThis / guess; // guess + S / guess
-		guess >>= 1;					 // guess / 2
-	};
+// Newton-Raphson iteration for y = x^(-1/n) without divisions
+// y' = y - y * (x * y^n - 1) / n, every step doubles the correct bits
+// so the working precision is doubled as well, starting from 64 bits
+// of a long double estimate. Requires 1 <= x < 2^n
+LongNumber LongNumber::inverseRoot(uint32_t n, uint32_t precision) const {
+	// Every step loses a few bits to truncation
+	constexpr uint32_t guardBits = 16;
+	constexpr uint32_t seedBits = 48;
+	LongNumber y(std::pow(toLongDouble(), -1.0L / n), 64);
+
+	std::vector<uint32_t> steps;
+	for (uint32_t p = precision; p > seedBits; p = p / 2 + guardBits)
+		steps.push_back(p);
+	for (auto p = steps.rbegin(); p != steps.rend(); p++) {
+		y.setPrecision(*p);
+		LongNumber error = withPrecision(*p) * y.pow(n);
+		error -= 1;
+		y -= y * error / n;
+	}
+	return y;
+}
 
-	guess.truncateWholePart();
-	guess.setPrecision(fractionBits);
-	return guess;
+// floor(value^(1/n)) for an integer `value` (0 bits precision)
+LongNumber LongNumber::integerRoot(const LongNumber &value, uint32_t n) {
+	size_t size =
+		kernels::normalizedSize(value.chunks.data(), value.chunks.size());
+	if (size == 0) return LongNumber(0, 0);
+	uint32_t bits =
+		digitsPerChunk * (size - 1) + std::bit_width(value.chunks[size - 1]);
+
+	// value = m * 2^(n * e) where 1 <= m < 2^n
+	uint32_t e = (bits - 1) / n;
+	LongNumber m = value.withPrecision(n * e) >> (n * e);
+	// Root has bits / n + 1 bits, the rest covers rounding errors
+	uint32_t precision = bits / n + 2 * std::bit_width(n) + 16;
+	m.setPrecision(std::min(m.fractionBits, precision));
+
+	LongNumber root = m * m.inverseRoot(n, precision).pow(n - 1);
+	root <<= e;
+	root.setPrecision(0);
+	// Estimate is off by at most one
+	while (root.pow(n) > value) root -= 1;
+	while ((root + 1).pow(n) <= value) root += 1;
+	return root;
 }
 
 // *OUTPUT UTILS*
@@ -301,7 +518,7 @@ const std::string LongArithm::LongNumber::toBinaryString(void) const {
 	}
 
 	if (fractionBits == 0) {
-		if (output.empty()) output = "0";
+		if (output.empty()) output = '0';
 		return output;
 	}
 	output += '.';
@@ -321,49 +538,170 @@ const std::string LongArithm::LongNumber::toBinaryString(void) const {
 }
 
 // Constructs a decimal string representation
+// Fraction digits are truncated, trailing zeros are omitted
 const std::string LongNumber::toString(uint32_t digitsAfterDecimal) const {
-	std::string output = "";
-
-	// Work with absolute values
-	LongNumber wholePart = (*this).withPrecision(0).abs();
-	LongNumber fracPart = (*this).abs();
-	fracPart.chunks.resize(getFractionChunks());
-
-	LongNumber base = LongNumber(10.0L, 0);
+	std::string output;
+	// A single block lets the conversion run in parallel
+	writeString(
+		[&](std::string_view block) { output += block; }, digitsAfterDecimal,
+		SIZE_MAX
+	);
+	return output;
+}
 
-	while (wholePart != 0) {
-		LongNumber q = wholePart / base;
-		LongNumber r = wholePart - (q * base);
-		assert(r < base);
+void LongNumber::writeString(
+	std::ostream &out, uint32_t digitsAfterDecimal, size_t blockDigits
+) const {
+	writeString(
+		[&](std::string_view block) { out.write(block.data(), block.size()); },
+		digitsAfterDecimal, blockDigits
+	);
+}
 
-		std::string newChar =
-			r.chunks.empty() ? "0" : std::to_string(r.chunks.front());
-		output += newChar;
+void LongNumber::writeString(
+	const DigitSink &sink, uint32_t digitsAfterDecimal, size_t blockDigits
+) const {
+	STATS_TIME(ToString, chunks.size());
+	if (sign == -1) sink("-");
 
-		wholePart = q;
+	uint32_t fractionChunks = getFractionChunks();
+	size_t wholeSize = kernels::normalizedSize(
+		chunks.data() + fractionChunks, chunks.size() - fractionChunks
+	);
+	if (wholeSize) {
+		// 2^(32 * n) has less than 32 * n * log10(2) + 1 digits
+		size_t digits = std::ceil(wholeSize * 32 * std::log10(2.0L)) + 1;
+		bool leading = true;
+		kernels::toDecimal(
+			chunks.data() + fractionChunks, wholeSize, digits, blockDigits,
+			[&](std::string_view block) {
+				if (leading) {
+					size_t first = block.find_first_not_of('0');
+					if (first == std::string_view::npos) return;
+					block.remove_prefix(first);
+					leading = false;
+				}
+				sink(block);
+			}
+		);
+	} else if (fractionBits == 0 && sign != -1) {
+		sink("0");
 	}
-	if (sign == -1) output += "-";
-	if (fractionBits == 0 && output.empty()) output = "0";
-
-	std::ranges::reverse(output);
 
-	if (fractionBits == 0 || digitsAfterDecimal == 0 || fracPart == 0)
-		return output;
-	output += ".";
-	uint32_t digitsCnt = 0;
+	// Masked (as in `getChunk`) fraction is zero, nothing to output
+	bool hasFraction = false;
+	for (uint32_t i = 0; i < fractionChunks && !hasFraction; i++)
+		hasFraction = getChunk(i) != 0;
+	if (fractionBits == 0 || digitsAfterDecimal == 0 || !hasFraction) return;
+
+	// Digits are floor(fraction * 10^digitsAfterDecimal), the fraction
+	// is stored as an integer scaled by 2^(32 * fractionChunks)
+	kernels::Limbs power = kernels::powerOfTen(digitsAfterDecimal);
+	kernels::Limbs scaled(fractionChunks + power.size());
+	kernels::mul(
+		scaled.data(), chunks.data(), fractionChunks, power.data(),
+		power.size()
+	);
+	// Output stops once the remainder masked (as in `getChunk`) is zero
+	// Masked bits can only hide a non zero remainder of the first
+	// `maskedBits` digits, past that the remainder has to be exactly zero
+	uint32_t maskedBits = fractionBits % digitsPerChunk
+							  ? digitsPerChunk - fractionBits % digitsPerChunk
+							  : 0;
+	kernels::Limbs remainder(
+		chunks.begin(), chunks.begin() + fractionChunks
+	);
+	uint32_t stop = 0;
+	for (uint32_t k = 1; k < std::min(maskedBits, digitsAfterDecimal); k++) {
+		kernels::mulWord(
+			remainder.data(), remainder.data(), fractionChunks, 10
+		);
+		if (kernels::normalizedSize(
+				remainder.data() + 1, fractionChunks - 1
+			) == 0 &&
+			remainder[0] >> maskedBits == 0) {
+			stop = k;
+			break;
+		}
+	}
+	bool trimZeros =
+		!stop && kernels::normalizedSize(scaled.data(), fractionChunks) == 0;
+
+	sink(".");
+	size_t remaining = stop ? stop : digitsAfterDecimal;
+	// Zeros are held back until a non zero digit follows them
+	size_t zeros = 0;
+	kernels::toDecimal(
+		scaled.data() + fractionChunks, power.size(), digitsAfterDecimal,
+		blockDigits,
+		[&](std::string_view block) {
+			block = block.substr(0, remaining);
+			remaining -= block.size();
+			if (!trimZeros) {
+				if (!block.empty()) sink(block);
+				return;
+			}
+			size_t last = block.find_last_not_of('0');
+			if (last == std::string_view::npos) {
+				zeros += block.size();
+				return;
+			}
+			for (; zeros > 0; zeros -= std::min(zeros, blockDigits))
+				sink(std::string(std::min(zeros, blockDigits), '0'));
+			sink(block.substr(0, last + 1));
+			zeros = block.size() - last - 1;
+		}
+	);
+}
 
-	while (digitsCnt++ < digitsAfterDecimal && fracPart != 0) {
-		fracPart *= base;
-		LongNumber r = fracPart.withPrecision(0);
+// *SERIALIZATION*
 
-		assert(r < base);
-		std::string newChar = r == 0 ? "0" : std::to_string(r.chunks.front());
+void LongNumber::serialize(std::ostream &out) const {
+	writeSerialHeader(out, {fractionBits, sign, chunks.size()});
+	if constexpr (std::endian::native == std::endian::little) {
+		out.write(
+			reinterpret_cast<const char *>(chunks.data()),
+			chunks.size() * sizeof(uint32_t)
+		);
+	} else {
+		for (uint32_t chunk : chunks) writeLittleEndian(out, chunk);
+	}
+}
 
-		fracPart -= r;
-		output += newChar;
+LongNumber LongNumber::deserialize(std::istream &in) {
+	SerialHeader header = readSerialHeader(in);
+	LongNumber result;
+	result.sign = header.sign;
+	result.fractionBits = header.fractionBits;
+	// The count is not trusted, the chunks grow block by block as far as
+	// the stream has limbs, so a forged header cannot allocate much
+	constexpr size_t blockLimbs = size_t(1) << 16;
+	for (size_t read = 0; read < header.limbCount;) {
+		size_t n = std::min<size_t>(blockLimbs, header.limbCount - read);
+		result.chunks.resize(read + n);
+		in.read(
+			reinterpret_cast<char *>(result.chunks.data() + read),
+			n * sizeof(uint32_t)
+		);
+		if (!in)
+			throw std::runtime_error("Failed to deserialize: truncated limbs");
+		read += n;
 	}
+	if constexpr (std::endian::native == std::endian::big)
+		for (uint32_t &chunk : result.chunks) chunk = std::byteswap(chunk);
+	result.normalize();
+	return result;
+}
 
-	return output;
+LongNumber LongNumber::fromLimbs(
+	std::span<const uint32_t> limbs, bool negative, uint32_t fractionBits
+) {
+	LongNumber result;
+	result.sign = negative ? -1 : 1;
+	result.fractionBits = fractionBits;
+	result.chunks.assign(limbs.begin(), limbs.end());
+	result.normalize();
+	return result;
 }
 
 // *OPERATORS*
@@ -373,121 +711,251 @@ std::strong_ordering LongNumber::operator<=>(const LongNumber &other) const {
 	if (sign < other.sign) return std::strong_ordering::less;
 	if (sign > other.sign) return std::strong_ordering::greater;
 
-	// If both numbers are zero, they are equal
-	if (chunks.empty() && other.chunks.empty())
-		return std::strong_ordering::equal;
+	// For negative numbers the comparison sign needs to be "reversed"
+	std::strong_ordering order = compareAbs(other);
+	return (sign == 1) ? order : 0 <=> order;
+}
+
+bool LongNumber::operator==(const LongNumber &other) const {
+	return (*this <=> other) == std::strong_ordering::equal;
+};
+
+namespace {
+// Bits of the lowest chunk that are within precision
+uint32_t lowChunkMask(uint32_t fractionBits) {
+	uint32_t bits = fractionBits % digitsPerChunk;
+	return bits == 0 ? UINT32_MAX : ~(UINT32_MAX >> bits);
+}
+
+// True if any of the `n` lowest chunks of a number is nonzero up to precision
+bool hasNonZero(const uint32_t *chunks, size_t n, uint32_t fractionBits) {
+	if (n == 0) return false;
+	return kernels::normalizedSize(chunks + 1, n - 1) != 0 ||
+		   (chunks[0] & lowChunkMask(fractionBits)) != 0;
+}
+} // namespace
 
+std::strong_ordering LongNumber::compareAbs(const LongNumber &other) const {
 	size_t wholeSizeThis = chunks.size() - getFractionChunks();
 	size_t wholeSizeOther = other.chunks.size() - other.getFractionChunks();
-
-	// For negative numbers the comparison sign needs to be "reversed"
 	if (wholeSizeThis != wholeSizeOther)
-		return (sign == 1) ? (wholeSizeThis <=> wholeSizeOther)
-						   : (wholeSizeOther <=> wholeSizeThis);
-
-	// Compare from most significant chunk downwards to account for potential precision mismatch
-	size_t maxSize = std::max(chunks.size(), other.chunks.size());
-	for (size_t i = 0; i < maxSize; i++) {
-		// If length is different assume missing chunk = 0
-		uint32_t chunkThis =
-			(i < chunks.size()) ? getChunk(chunks.size() - i - 1) : 0;
-		uint32_t chunkOther = (i < other.chunks.size())
-								  ? other.getChunk(other.chunks.size() - i - 1)
-								  : 0;
-
-		if (chunkThis != chunkOther) {
-			return (sign == 1) ? (chunkThis <=> chunkOther)
-							   : (chunkOther <=> chunkThis);
-		}
+		return wholeSizeThis <=> wholeSizeOther;
+
+	// Chunks are aligned at the binary point, so the top `common` chunks
+	// of both numbers have the same weights
+	size_t common = std::min(chunks.size(), other.chunks.size());
+	const uint32_t *a = chunks.data() + chunks.size() - common;
+	const uint32_t *b = other.chunks.data() + other.chunks.size() - common;
+	// Lowest chunks are masked by precision, they are compared separately
+	bool lowest =
+		common > 0 && (a == chunks.data() || b == other.chunks.data());
+	int order = kernels::compareN(a + lowest, b + lowest, common - lowest);
+	if (order != 0) return order <=> 0;
+	if (lowest) {
+		uint32_t chunkThis = a[0], chunkOther = b[0];
+		if (a == chunks.data()) chunkThis &= lowChunkMask(fractionBits);
+		if (b == other.chunks.data())
+			chunkOther &= lowChunkMask(other.fractionBits);
+		if (chunkThis != chunkOther) return chunkThis <=> chunkOther;
 	}
+
+	// Only one of the numbers has chunks left, missing ones are zeros
+	if (hasNonZero(chunks.data(), chunks.size() - common, fractionBits))
+		return std::strong_ordering::greater;
+	if (hasNonZero(
+			other.chunks.data(), other.chunks.size() - common,
+			other.fractionBits
+		))
+		return std::strong_ordering::less;
 	return std::strong_ordering::equal;
 }
 
-bool LongNumber::operator==(const LongNumber &other) const {
-	return (*this <=> other) == std::strong_ordering::equal;
-};
+// True if every chunk is zero up to precision, regardless of sign
+// Nonzero numbers usually end the scan at their top chunk
+bool LongNumber::isZero(void) const {
+	return !hasNonZero(chunks.data(), chunks.size(), fractionBits);
+}
 
-LongNumber LongNumber::operator+(const LongNumber &other) const {
-	if (sign != other.sign) {
-		if (sign == -1) return other - (-(*this)); // -a + b = b - a
-		return *this - (-other);				   // a + -b = a - b
-	}
+// *IN PLACE ADDITION AND SUBTRACTION*
+
+void LongNumber::addMagnitude(const LongNumber &other) {
+	if (other.fractionBits > fractionBits) setPrecision(other.fractionBits);
+	// `other` is aligned with `this` by skipping extra fraction chunks
+	size_t offset = getFractionChunks() - other.getFractionChunks();
+	if (chunks.size() < offset + other.chunks.size())
+		chunks.resize(offset + other.chunks.size(), 0);
+
+	uint32_t carry = kernels::addInPlace(
+		chunks.data() + offset, chunks.size() - offset, other.chunks.data(),
+		other.chunks.size()
+	);
+	if (carry != 0) chunks.push_back(carry);
+}
+
+void LongNumber::subMagnitude(const LongNumber &other) {
 	uint32_t maxPrecision = std::max(fractionBits, other.fractionBits);
-	LongNumber result(0, maxPrecision);
-	result.sign = sign;
-	size_t maxSize = std::max(chunks.size(), other.chunks.size());
-	result.chunks.resize(maxSize);
-
-	LongNumber a = (*this).withPrecision(maxPrecision);
-	LongNumber b = other.withPrecision(maxPrecision);
-
-	uint32_t carry = 0;
-	for (uint32_t i = 0; i < maxSize; i++) {
-		uint64_t sum = carry;
-		if (i < a.chunks.size()) sum += a.chunks[i];
-		if (i < b.chunks.size()) sum += b.chunks[i];
-
-		carry = sum >> digitsPerChunk;
-		result.chunks[i] = static_cast<uint32_t>(sum);
+	if (compareAbs(other) == std::strong_ordering::equal) {
+		sign = 1;
+		fractionBits = maxPrecision;
+		chunks.clear();
+		allocateFraction();
+		return;
 	}
-	if (carry != 0) result.chunks.push_back(carry);
-	return result;
+	setPrecision(maxPrecision);
+	size_t offset = getFractionChunks() - other.getFractionChunks();
+	if (chunks.size() < offset + other.chunks.size())
+		chunks.resize(offset + other.chunks.size(), 0);
+
+	// If |a| < |b| then a - b wraps around and |a - b| = -(a - b)
+	uint32_t borrow = kernels::subInPlace(
+		chunks.data() + offset, chunks.size() - offset, other.chunks.data(),
+		other.chunks.size()
+	);
+	if (borrow != 0) {
+		kernels::negate(chunks.data(), chunks.size());
+		sign = -sign;
+	}
+	// Remove leading zero chunks
+	truncateWholePart();
+	if (isZero()) sign = 1;
 }
 
-LongNumber LongNumber::operator-() const {
-	// -0 = +0
-	if ((*this).chunks.empty()) return *this;
-	LongNumber result = *this;
-	result.sign = -result.sign;
-	return result;
-}
+// *INTEGER OPERANDS*
 
-LongNumber LongNumber::operator-(const LongNumber &other) const {
-	// -a - b -> -a + -b || a - (-b) -> a + b
-	if (sign != other.sign) return *this + (-other);
+void LongNumber::addInteger(uint64_t value, bool negative) {
+	STATS_TIME(Add, chunks.size());
+	if (value == 0) return;
+	uint32_t limbs[2] = {
+		static_cast<uint32_t>(value), static_cast<uint32_t>(value >> 32)
+	};
+	size_t limbCount = limbs[1] != 0 ? 2 : 1;
+	// Integer part starts right after the fraction
+	size_t offset = getFractionChunks();
+	if (chunks.size() < offset + limbCount)
+		chunks.resize(offset + limbCount, 0);
+
+	if (negative == (sign == -1)) {
+		uint32_t carry = kernels::addInPlace(
+			chunks.data() + offset, chunks.size() - offset, limbs, limbCount
+		);
+		if (carry != 0) chunks.push_back(carry);
+		return;
+	}
+	uint32_t borrow = kernels::subInPlace(
+		chunks.data() + offset, chunks.size() - offset, limbs, limbCount
+	);
+	if (borrow != 0) {
+		kernels::negate(chunks.data(), chunks.size());
+		sign = -sign;
+	}
+	truncateWholePart();
+	if (isZero()) sign = 1;
+}
 
-	size_t maxPrecision = std::max(fractionBits, other.fractionBits);
-	if (*this == other) {
-		LongNumber result = LongNumber(0, maxPrecision);
-		result.sign = 1;
-		return result;
+void LongNumber::mulInteger(uint64_t value, bool negative) {
+	STATS_TIME(Multiply, chunks.size());
+	// x * 0 = 0
+	if (value == 0 || isZero()) {
+		sign = 1;
+		chunks.clear();
+		allocateFraction();
+		return;
 	}
+	uint32_t *data = chunks.data();
+	uint64_t carry;
+	if (value <= UINT32_MAX)
+		carry = kernels::mulWord(data, data, chunks.size(), value);
+	else
+		carry = kernels::mulDoubleWord(data, data, chunks.size(), value);
+	for (; carry != 0; carry >>= 32)
+		chunks.push_back(static_cast<uint32_t>(carry));
+	if (negative) sign = -sign;
+}
 
-	// If |a| < |b|, result is negative
-	bool negateResult = (*this < other);
-	const LongNumber &larger = negateResult ? other : *this;
+// Dividing the chunks directly gives the quotient with `fractionBits`
+void LongNumber::divInteger(uint64_t value, bool negative) {
+	STATS_TIME(Divide, chunks.size());
+	if (value == 0) throw std::invalid_argument("Division by zero");
+	uint32_t *data = chunks.data();
+	if (value <= UINT32_MAX)
+		kernels::divWord(data, data, chunks.size(), value);
+	else
+		kernels::divDoubleWord(data, data, chunks.size(), value);
+	truncateWholePart();
+	if (negative) sign = -sign;
+	if (isZero()) sign = 1;
+}
 
-	LongNumber smaller = negateResult ? *this : other;
-	smaller.setPrecision(larger.fractionBits);
+LongNumber &LongNumber::operator+=(const LongNumber &other) {
+	STATS_TIME(Add, chunks.size() + other.chunks.size());
+	if (sign == other.sign)
+		addMagnitude(other);
+	else
+		subMagnitude(other); // a + -b = a - b
+	return *this;
+}
 
-	LongNumber result(0, maxPrecision);
-	result.sign = negateResult ? -1 : 1;
+LongNumber &LongNumber::operator-=(const LongNumber &other) {
+	STATS_TIME(Subtract, chunks.size() + other.chunks.size());
+	if (sign == other.sign)
+		subMagnitude(other);
+	else
+		addMagnitude(other); // a - (-b) = a + b
+	return *this;
+}
 
-	size_t maxSize = larger.chunks.size();
-	result.chunks.resize(maxSize);
+LongNumber LongNumber::operator+(const LongNumber &other) const {
+	LongNumber result = *this;
+	result += other;
+	return result;
+}
 
-	int64_t borrow = 0;
-	for (size_t i = 0; i < maxSize; i++) {
-		int64_t diff = static_cast<int64_t>(larger.chunks[i]) - borrow;
-		if (i < smaller.chunks.size()) {
-			diff -= smaller.chunks[i];
-		}
+LongNumber LongNumber::operator-(const LongNumber &other) const {
+	LongNumber result = *this;
+	result -= other;
+	return result;
+}
 
-		if (diff < 0) {
-			borrow = 1;
-			diff += (1LL << digitsPerChunk);
-		} else {
-			borrow = 0;
-		}
+LongNumber operator+(LongNumber &&lhs, const LongNumber &rhs) {
+	lhs += rhs;
+	return std::move(lhs);
+}
+LongNumber operator+(const LongNumber &lhs, LongNumber &&rhs) {
+	rhs += lhs;
+	return std::move(rhs);
+}
+LongNumber operator+(LongNumber &&lhs, LongNumber &&rhs) {
+	lhs += rhs;
+	return std::move(lhs);
+}
 
-		result.chunks[i] = static_cast<uint32_t>(diff);
-	}
-	// Remove leading zero chunks
-	result.truncateWholePart();
-	return result;
+LongNumber operator-(LongNumber &&lhs, const LongNumber &rhs) {
+	lhs -= rhs;
+	return std::move(lhs);
+}
+// a - b = -(b - a)
+LongNumber operator-(const LongNumber &lhs, LongNumber &&rhs) {
+	rhs -= lhs;
+	return -std::move(rhs);
+}
+LongNumber operator-(LongNumber &&lhs, LongNumber &&rhs) {
+	lhs -= rhs;
+	return std::move(lhs);
+}
+
+LongNumber LongNumber::operator-() const & {
+	LongNumber result = *this;
+	return -std::move(result);
+}
+
+LongNumber LongNumber::operator-() && {
+	// -0 = +0
+	if (!isZero()) sign = -sign;
+	return std::move(*this);
 }
 
 LongNumber LongNumber::operator*(const LongNumber &other) const {
+	STATS_TIME(Multiply, chunks.size() + other.chunks.size());
 	// Round to digitsPerChunk
 	// Prevent overflow of uint32_t by picking min
 	uint32_t newPrecision = std::min(
@@ -496,25 +964,27 @@ LongNumber LongNumber::operator*(const LongNumber &other) const {
 	);
 	uint32_t maxPrecisionBits = std::max(fractionBits, other.fractionBits);
 	LongNumber result(0.0L, newPrecision);
-	result.sign = sign * other.sign;
 
 	// x * 0 = 0
-	if (*this == 0 || other == 0) {
+	if (isZero() || other.isZero()) {
 		result.setPrecision(maxPrecisionBits);
 		return result;
 	}
+	result.sign = sign * other.sign;
 	result.chunks.resize(chunks.size() + other.chunks.size());
 
-	for (size_t i = 0; i < chunks.size(); i++) {
-		uint32_t carry = 0;
-		for (size_t j = 0; j < other.chunks.size(); j++) {
-			uint64_t mult = static_cast<uint64_t>(chunks[i]) * other.chunks[j] +
-							carry + result.chunks[i + j];
-			result.chunks[i + j] = static_cast<uint32_t>(mult);
-			carry = mult >> digitsPerChunk;
-		}
-		result.chunks[i + other.chunks.size()] += carry;
-	}
+	// Zero chunks on both ends do not affect the product, skip them
+	size_t lowThis = kernels::lowZeroCount(chunks.data(), chunks.size());
+	size_t lowOther =
+		kernels::lowZeroCount(other.chunks.data(), other.chunks.size());
+	size_t sizeThis = kernels::normalizedSize(chunks.data(), chunks.size());
+	size_t sizeOther =
+		kernels::normalizedSize(other.chunks.data(), other.chunks.size());
+	kernels::mul(
+		result.chunks.data() + lowThis + lowOther, chunks.data() + lowThis,
+		sizeThis - lowThis, other.chunks.data() + lowOther,
+		sizeOther - lowOther
+	);
 	result.truncateWholePart();
 	// Set precision to max (not rounding by digitsPerChunk)
 	result.setPrecision(maxPrecisionBits);
@@ -522,50 +992,46 @@ LongNumber LongNumber::operator*(const LongNumber &other) const {
 }
 
 LongNumber LongNumber::operator/(const LongNumber &other) const {
-	if (other == 0) throw std::invalid_argument("Division by zero");
+	STATS_TIME(Divide, chunks.size() + other.chunks.size());
+	if (other.isZero()) throw std::invalid_argument("Division by zero");
 
 	uint32_t maxPrecision = std::max(fractionBits, other.fractionBits);
 	// Set min `fractionBits` for division
 	// Allows to accuratly divide "integer" values
 	uint32_t normPrecision = std::max(maxPrecision, 96U);
 
-	// Work with absolute values
-	LongNumber dividend = (*this).abs().withPrecision(normPrecision);
-
-	LongNumber divisor = other.abs().withPrecision(normPrecision);
-
-	// Shift fraction part (full chunks)
-	dividend <<= dividend.getFractionChunks() * digitsPerChunk;
-
 	LongNumber quotient(0.0L, normPrecision);
 	quotient.sign = sign * other.sign;
-	LongNumber remainder(0.0L, normPrecision);
-
-	// Bitwise division
-	for (int i = dividend.chunks.size() * digitsPerChunk - 1; i >= 0; --i) {
-		remainder <<= 1;
-		remainder.chunks[0] |= (dividend.getBit(i) ? 1 : 0);
-		if (remainder >= divisor) {
-			remainder -= divisor;
-			quotient.setBit(i);
-		}
+
+	// this = A / 2^(32 * fa), other = B / 2^(32 * fb) where A, B are chunks
+	// Quotient with `fc` fraction chunks is A * 2^(32 * (fc + fb - fa)) / B
+	// Both operands are used in place, only the numerator is copied
+	uint32_t fractionChunks = quotient.getFractionChunks();
+	size_t numeratorShift =
+		fractionChunks + other.getFractionChunks() - getFractionChunks();
+	kernels::Limbs numerator(numeratorShift + chunks.size(), 0);
+	std::copy(chunks.begin(), chunks.end(), numerator.begin() + numeratorShift);
+	size_t numeratorSize =
+		kernels::normalizedSize(numerator.data(), numerator.size());
+	size_t divisorSize =
+		kernels::normalizedSize(other.chunks.data(), other.chunks.size());
+
+	if (numeratorSize >= divisorSize) {
+		quotient.chunks.resize(
+			std::max<size_t>(numeratorSize - divisorSize + 1, fractionChunks)
+		);
+		kernels::divmod(
+			quotient.chunks.data(), nullptr, numerator.data(), numeratorSize,
+			other.chunks.data(), divisorSize
+		);
 	}
 	quotient.setPrecision(maxPrecision);
 	// Should not be neccessary, more of a precaution
 	quotient.truncateWholePart();
+	if (quotient.isZero()) quotient.sign = 1;
 	return quotient;
 }
 
-LongNumber &LongNumber::operator+=(const LongNumber &other) {
-	*this = *this + other;
-	return *this;
-}
-
-LongNumber &LongNumber::operator-=(const LongNumber &other) {
-	*this = *this - other;
-	return *this;
-}
-
 LongNumber &LongNumber::operator*=(const LongNumber &other) {
 	*this = *this * other;
 	return *this;
@@ -584,21 +1050,20 @@ LongNumber &LongNumber::operator<<=(int shift) {
 		*this >>= -shift;
 		return *this;
 	};
+	STATS_TIME(Shift, chunks.size());
 
 	uint32_t chunkShift = shift / digitsPerChunk;
 	uint32_t bitShift = shift % digitsPerChunk;
 
 	if (chunkShift > 0) chunks.insert(chunks.begin(), chunkShift, 0);
-	if (bitShift == 0) return *this;
-
-	uint32_t carry = 0;
-	for (size_t i = 0; i < chunks.size(); i++) {
-		uint32_t newCarry = chunks[i] >> (digitsPerChunk - bitShift);
-		chunks[i] = (chunks[i] << bitShift) | carry;
-		carry = newCarry;
+	if (bitShift != 0) {
+		uint32_t carry = kernels::shiftLeft(
+			chunks.data(), chunks.data(), chunks.size(), bitShift
+		);
+		if (carry) chunks.push_back(carry);
 	}
-
-	if (carry) chunks.push_back(carry);
+	// Leading zero fraction chunks may have become whole chunks
+	truncateWholePart();
 	return *this;
 }
 LongNumber &LongNumber::operator>>=(int shift) {
@@ -607,6 +1072,7 @@ LongNumber &LongNumber::operator>>=(int shift) {
 		*this <<= -shift;
 		return *this;
 	};
+	STATS_TIME(Shift, chunks.size());
 
 	uint32_t chunkShift = shift / digitsPerChunk;
 	uint32_t bitShift = shift % digitsPerChunk;
@@ -622,13 +1088,7 @@ LongNumber &LongNumber::operator>>=(int shift) {
 	allocateFraction();
 	if (bitShift == 0) return *this;
 
-	uint32_t carry = 0;
-	for (int i = chunks.size() - 1; i >= 0; i--) {
-		// 0 <= bitShift < digitsPerChunk No UB
-		uint32_t newCarry = chunks[i] << (digitsPerChunk - bitShift);
-		chunks[i] = (chunks[i] >> bitShift) | carry;
-		carry = newCarry;
-	}
+	kernels::shiftRight(chunks.data(), chunks.data(), chunks.size(), bitShift);
 	truncateWholePart();
 	return *this;
 }
@@ -640,13 +1100,4 @@ LongNumber operator>>(LongNumber lhs, int shift) {
 	lhs >>= shift;
 	return lhs;
 }
-
-// *COPY OPERATOR*
-
-LongNumber &LongNumber::operator=(const LongNumber other) {
-	sign = other.sign;
-	fractionBits = other.fractionBits;
-	chunks = other.chunks;
-	return *this;
-}
 } // namespace LongArithm
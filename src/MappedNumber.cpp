@@ -0,0 +1,95 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <spanstream>
+#include <stdexcept>
+#include <utility>
+
+#include "MappedNumber.hpp"
+#include "Serialization.hpp"
+
+namespace LongArithm {
+MappedNumber::MappedNumber(const std::string &path) {
+	if constexpr (std::endian::native != std::endian::little)
+		throw std::runtime_error("Mapped numbers require a little endian host");
+
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error(
+			"Failed to open " + path + ": " + std::strerror(errno)
+		);
+	struct stat status;
+	if (fstat(fd, &status) != 0 || status.st_size == 0) {
+		close(fd);
+		throw std::runtime_error("Failed to map " + path + ": empty file");
+	}
+	mappedBytes = status.st_size;
+	mapping = mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after the descriptor is closed
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		mapping = nullptr;
+		throw std::runtime_error(
+			"Failed to map " + path + ": " + std::strerror(errno)
+		);
+	}
+
+	const char *bytes = static_cast<const char *>(mapping);
+	try {
+		std::ispanstream stream(std::span<const char>(bytes, mappedBytes));
+		SerialHeader header = readSerialHeader(stream);
+		if (header.limbCount >
+			(mappedBytes - SerialHeader::size) / sizeof(uint32_t))
+			throw std::runtime_error("Failed to deserialize: truncated limbs");
+		numberSign = header.sign;
+		numberFractionBits = header.fractionBits;
+		// Pages are aligned and so is the header, no copy is needed
+		numberLimbs = std::span<const uint32_t>(
+			reinterpret_cast<const uint32_t *>(bytes + SerialHeader::size),
+			header.limbCount
+		);
+	} catch (...) {
+		unmap();
+		throw;
+	}
+	madvise(mapping, mappedBytes, MADV_SEQUENTIAL);
+}
+
+MappedNumber::~MappedNumber() { unmap(); }
+
+MappedNumber::MappedNumber(MappedNumber &&other) noexcept
+	: mapping(std::exchange(other.mapping, nullptr)),
+	  mappedBytes(std::exchange(other.mappedBytes, 0)),
+	  numberSign(other.numberSign),
+	  numberFractionBits(other.numberFractionBits),
+	  numberLimbs(std::exchange(other.numberLimbs, {})) {}
+
+MappedNumber &MappedNumber::operator=(MappedNumber &&other) noexcept {
+	if (this == &other) return *this;
+	unmap();
+	mapping = std::exchange(other.mapping, nullptr);
+	mappedBytes = std::exchange(other.mappedBytes, 0);
+	numberSign = other.numberSign;
+	numberFractionBits = other.numberFractionBits;
+	numberLimbs = std::exchange(other.numberLimbs, {});
+	return *this;
+}
+
+void MappedNumber::unmap(void) {
+	if (mapping != nullptr) munmap(mapping, mappedBytes);
+	mapping = nullptr;
+	mappedBytes = 0;
+	numberLimbs = {};
+}
+
+LongNumber MappedNumber::toLongNumber(void) const {
+	return LongNumber::fromLimbs(
+		numberLimbs, numberSign == -1, numberFractionBits
+	);
+}
+} // namespace LongArithm
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "LongArithm.hpp"
+
+namespace LongArithm {
+// Read-only view of a file written by `LongNumber::serialize`
+// The file is memory-mapped and the limbs are read from the page cache
+// in place, opening a number costs the same for any size
+class MappedNumber {
+  private:
+	void *mapping = nullptr;
+	size_t mappedBytes = 0;
+	short numberSign = 1;
+	uint32_t numberFractionBits = 0;
+	std::span<const uint32_t> numberLimbs;
+
+	void unmap(void);
+
+  public:
+	// Throws `std::runtime_error` if the file cannot be mapped or does not
+	// hold a serialized number, or on big endian hosts
+	explicit MappedNumber(const std::string &path);
+	~MappedNumber();
+	MappedNumber(MappedNumber &&other) noexcept;
+	MappedNumber &operator=(MappedNumber &&other) noexcept;
+	MappedNumber(const MappedNumber &) = delete;
+	MappedNumber &operator=(const MappedNumber &) = delete;
+
+	short sign(void) const { return numberSign; }
+	uint32_t fractionBits(void) const { return numberFractionBits; }
+	// Little endian limbs pointing into the mapping, valid while it lives
+	std::span<const uint32_t> limbs(void) const { return numberLimbs; }
+	// Copies the limbs into a regular number
+	LongNumber toLongNumber(void) const;
+};
+} // namespace LongArithm
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+
+// Binary files are little endian regardless of the host
+namespace LongArithm {
+template <std::unsigned_integral T>
+void writeLittleEndian(std::ostream &out, T value) {
+	if constexpr (std::endian::native == std::endian::big)
+		value = std::byteswap(value);
+	out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// Returns 0 and sets failbit on the stream if it ends early
+template <std::unsigned_integral T> T readLittleEndian(std::istream &in) {
+	T value = 0;
+	if (!in.read(reinterpret_cast<char *>(&value), sizeof(value))) return 0;
+	if constexpr (std::endian::native == std::endian::big)
+		value = std::byteswap(value);
+	return value;
+}
+
+// Header of `LongNumber::serialize`, the limbs follow right after it
+// Fields are little endian: magic, version (u32), fractionBits (u32),
+// sign (i32), limb count (u64). Limbs are 4 byte aligned in the file
+struct SerialHeader {
+	static constexpr char magic[4] = {'L', 'N', 'U', 'M'};
+	static constexpr uint32_t version = 1;
+	static constexpr size_t size = 24;
+
+	uint32_t fractionBits;
+	int32_t sign;
+	uint64_t limbCount;
+};
+
+inline void writeSerialHeader(std::ostream &out, const SerialHeader &header) {
+	out.write(SerialHeader::magic, sizeof(SerialHeader::magic));
+	writeLittleEndian<uint32_t>(out, SerialHeader::version);
+	writeLittleEndian<uint32_t>(out, header.fractionBits);
+	writeLittleEndian<uint32_t>(out, header.sign);
+	writeLittleEndian<uint64_t>(out, header.limbCount);
+}
+
+// Throws `std::runtime_error` if `in` does not start with a valid header
+// or the limb count is below the fraction chunks
+inline SerialHeader readSerialHeader(std::istream &in) {
+	char magic[sizeof(SerialHeader::magic)] = {};
+	in.read(magic, sizeof(magic));
+	if (!in || !std::equal(magic, magic + sizeof(magic), SerialHeader::magic))
+		throw std::runtime_error("Failed to deserialize: not a LongNumber");
+	if (readLittleEndian<uint32_t>(in) != SerialHeader::version)
+		throw std::runtime_error("Failed to deserialize: unknown version");
+
+	SerialHeader header;
+	header.fractionBits = readLittleEndian<uint32_t>(in);
+	header.sign = static_cast<int32_t>(readLittleEndian<uint32_t>(in));
+	header.limbCount = readLittleEndian<uint64_t>(in);
+	// Serialized numbers always store every fraction chunk, so the count
+	// bounds the fraction and a forged one cannot make it allocate limbs
+	uint64_t fractionChunks = (uint64_t(header.fractionBits) + 31) / 32;
+	if (!in || (header.sign != 1 && header.sign != -1) ||
+		header.limbCount > UINT32_MAX || fractionChunks > header.limbCount)
+		throw std::runtime_error("Failed to deserialize: corrupted header");
+	return header;
+}
+} // namespace LongArithm
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "LimbPool.hpp"
+
+namespace LongArithm {
+// Vector that stores up to `N` elements inline and spills to the heap
+// Heap blocks come from `poolAllocate` (see `ArenaScope`)
+// Only supports trivially copyable types, elements are moved with memmove
+// Provides the subset of `std::vector` interface used by `LongNumber`
+// Elements are a window into the buffer: erasing from the front only moves
+// the start of the window and inserting at the front uses the free room
+// before it, so neither moves the rest of the elements
+template <typename T, size_t N> class SmallVector {
+	static_assert(std::is_trivially_copyable_v<T>);
+
+  private:
+	// Start of the buffer of `cap` elements
+	T *base;
+	// First element, `ptr - base` elements before it are free
+	T *ptr;
+	size_t count;
+	size_t cap;
+	T inlineBuffer[N];
+
+	bool isInline(void) const { return base == inlineBuffer; }
+	size_t frontRoom(void) const { return ptr - base; }
+
+	// Moves the contents to a new block with `front` free elements before
+	// them and room for `back` elements from the first one
+	void reallocate(size_t front, size_t back) {
+		size_t bytes = (front + back) * sizeof(T);
+		T *block = static_cast<T *>(poolAllocate(bytes));
+		std::copy(ptr, ptr + count, block + front);
+		if (!isInline()) poolDeallocate(base);
+		base = block;
+		ptr = block + front;
+		// The pool may round the block up
+		cap = bytes / sizeof(T);
+	}
+
+	// Makes room for at least `n` elements from the first one keeping the
+	// contents. Free room in front is kept up to the size of the contents
+	void grow(size_t n) {
+		if (frontRoom() + n <= cap) return;
+		// Inline contents are short, sliding them is cheaper than a new block
+		if (isInline() && n <= N) {
+			std::copy(ptr, ptr + count, base);
+			ptr = base;
+			return;
+		}
+		reallocate(std::min(frontRoom(), count), std::max(2 * count, n));
+	}
+
+	// Opens a gap of `n` elements at `index`, returns its start
+	T *openGap(size_t index, size_t n) {
+		if (index == 0 && !isInline()) {
+			// Leaves room for later insertions in front as well
+			if (frontRoom() < n) reallocate(n + count / 2, count + n);
+			ptr -= n;
+			count += n;
+			return ptr;
+		}
+		grow(count + n);
+		std::copy_backward(ptr + index, ptr + count, ptr + count + n);
+		count += n;
+		return ptr + index;
+	}
+
+  public:
+	using value_type = T;
+	using iterator = T *;
+	using const_iterator = const T *;
+
+	SmallVector()
+		: base(inlineBuffer), ptr(inlineBuffer), count(0), cap(N) {}
+	explicit SmallVector(size_t n, const T &value = T()) : SmallVector() {
+		resize(n, value);
+	}
+	template <std::input_iterator It>
+	SmallVector(It first, It last) : SmallVector() {
+		insert(end(), first, last);
+	}
+	SmallVector(std::initializer_list<T> values)
+		: SmallVector(values.begin(), values.end()) {}
+
+	SmallVector(const SmallVector &other)
+		: SmallVector(other.begin(), other.end()) {}
+	SmallVector(SmallVector &&other) noexcept : SmallVector() {
+		*this = std::move(other);
+	}
+	~SmallVector() {
+		if (!isInline()) poolDeallocate(base);
+	}
+
+	SmallVector &operator=(const SmallVector &other) {
+		if (this == &other) return *this;
+		clear();
+		grow(other.count);
+		std::copy(other.begin(), other.end(), ptr);
+		count = other.count;
+		return *this;
+	}
+	// Steals the heap buffer of `other`, inline contents are copied
+	SmallVector &operator=(SmallVector &&other) noexcept {
+		if (this == &other) return *this;
+		if (other.isInline()) {
+			clear();
+			grow(other.count);
+			std::copy(other.begin(), other.end(), ptr);
+			count = other.count;
+		} else {
+			if (!isInline()) poolDeallocate(base);
+			base = other.base;
+			ptr = other.ptr;
+			cap = other.cap;
+			count = other.count;
+			other.base = other.ptr = other.inlineBuffer;
+			other.cap = N;
+		}
+		other.count = 0;
+		return *this;
+	}
+
+	size_t size(void) const { return count; }
+	// Elements that fit from the first one without reallocating
+	size_t capacity(void) const { return cap - frontRoom(); }
+	bool empty(void) const { return count == 0; }
+	T *data(void) { return ptr; }
+	const T *data(void) const { return ptr; }
+
+	iterator begin(void) { return ptr; }
+	iterator end(void) { return ptr + count; }
+	const_iterator begin(void) const { return ptr; }
+	const_iterator end(void) const { return ptr + count; }
+
+	T &operator[](size_t index) { return ptr[index]; }
+	const T &operator[](size_t index) const { return ptr[index]; }
+	T &front(void) { return ptr[0]; }
+	const T &front(void) const { return ptr[0]; }
+	T &back(void) { return ptr[count - 1]; }
+	const T &back(void) const { return ptr[count - 1]; }
+
+	void reserve(size_t n) { grow(n); }
+	// [first, last) must not point into this vector
+	template <std::input_iterator It> void assign(It first, It last) {
+		clear();
+		insert(end(), first, last);
+	}
+	void clear(void) {
+		ptr = base;
+		count = 0;
+	}
+	void resize(size_t n, const T &value = T()) {
+		grow(n);
+		if (n > count) std::fill(ptr + count, ptr + n, value);
+		count = n;
+	}
+	void push_back(const T &value) {
+		if (count == capacity()) {
+			// `value` may point into the buffer that is about to be freed
+			T copy = value;
+			grow(count + 1);
+			ptr[count++] = copy;
+			return;
+		}
+		ptr[count++] = value;
+	}
+	void pop_back(void) { count--; }
+
+	iterator insert(const_iterator pos, size_t n, const T &value) {
+		T copy = value;
+		T *gap = openGap(pos - ptr, n);
+		std::fill(gap, gap + n, copy);
+		return gap;
+	}
+	// [first, last) must not point into this vector
+	template <std::input_iterator It>
+	iterator insert(const_iterator pos, It first, It last) {
+		size_t n = std::distance(first, last);
+		T *gap = openGap(pos - ptr, n);
+		std::copy(first, last, gap);
+		return gap;
+	}
+	iterator erase(const_iterator first, const_iterator last) {
+		if (first == ptr) {
+			ptr += last - first;
+			count -= last - first;
+			return ptr;
+		}
+		T *from = ptr + (first - ptr);
+		std::copy(last, const_iterator(end()), from);
+		count -= last - first;
+		return from;
+	}
+};
+} // namespace LongArithm
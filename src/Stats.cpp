@@ -0,0 +1,128 @@
+#include <array>
+#include <atomic>
+#include <iomanip>
+#include <sstream>
+
+#include "Stats.hpp"
+
+namespace LongArithm::stats {
+namespace {
+constexpr size_t counterCount = static_cast<size_t>(Counter::Count);
+
+// In the order of `Counter`
+constexpr std::array<const char *, counterCount> names = {
+	"add",
+	"subtract",
+	"multiply",
+	"divide",
+	"shift",
+	"pow",
+	"root",
+	"toString",
+	"fromString",
+	"mul schoolbook",
+	"mul karatsuba",
+	"mul toom3",
+	"mul ntt",
+	"sqr schoolbook",
+	"sqr karatsuba",
+	"sqr toom3",
+	"sqr ntt",
+	"div knuth",
+	"div newton",
+	"to decimal",
+	"from decimal",
+	"allocation",
+};
+
+struct Counters {
+	std::atomic<uint64_t> calls{0};
+	std::atomic<uint64_t> limbs{0};
+	std::atomic<uint64_t> nanoseconds{0};
+};
+std::array<Counters, counterCount> counters;
+
+// Active timers of the current thread for every counter
+thread_local std::array<uint32_t, counterCount> depth{};
+
+// 1234.5 -> "1.23 us"
+std::string formatTime(double ns) {
+	const char *units[] = {"ns", "us", "ms", "s"};
+	int unit = 0;
+	for (; unit < 3 && ns >= 1000; unit++) ns /= 1000;
+	std::ostringstream output;
+	output << std::fixed << std::setprecision(2) << ns << ' ' << units[unit];
+	return output.str();
+}
+} // namespace
+
+bool enabled(void) {
+#ifdef LONGARITHM_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::vector<Entry> snapshot(void) {
+	std::vector<Entry> entries;
+	for (size_t i = 0; i < counterCount; i++) {
+		entries.push_back(
+			{names[i], counters[i].calls, counters[i].limbs,
+			 counters[i].nanoseconds}
+		);
+	}
+	return entries;
+}
+
+void reset(void) {
+	for (Counters &counter : counters) {
+		counter.calls = 0;
+		counter.limbs = 0;
+		counter.nanoseconds = 0;
+	}
+}
+
+void dump(std::ostream &out) {
+	if (!enabled()) {
+		out << "Statistics are disabled, rebuild with STATS=1\n";
+		return;
+	}
+	out << std::left << std::setw(16) << "Operation" << std::right
+		<< std::setw(12) << "Calls" << std::setw(16) << "Limbs"
+		<< std::setw(14) << "Time" << '\n'
+		<< std::string(58, '-') << '\n';
+	for (const Entry &entry : snapshot()) {
+		if (entry.calls == 0) continue;
+		out << std::left << std::setw(16) << entry.name << std::right
+			<< std::setw(12) << entry.calls << std::setw(16) << entry.limbs
+			<< std::setw(14)
+			<< (entry.nanoseconds ? formatTime(entry.nanoseconds) : "-")
+			<< '\n';
+	}
+}
+
+void record(Counter counter, size_t limbs, uint64_t nanoseconds) {
+	Counters &target = counters[static_cast<size_t>(counter)];
+	target.calls.fetch_add(1, std::memory_order_relaxed);
+	target.limbs.fetch_add(limbs, std::memory_order_relaxed);
+	if (nanoseconds != 0)
+		target.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+Timer::Timer(Counter counter, size_t limbs)
+	: counter(counter), limbs(limbs),
+	  outermost(depth[static_cast<size_t>(counter)]++ == 0),
+	  start(std::chrono::steady_clock::now()) {}
+
+Timer::~Timer() {
+	depth[static_cast<size_t>(counter)]--;
+	uint64_t nanoseconds = 0;
+	if (outermost) {
+		std::chrono::nanoseconds elapsed =
+			std::chrono::steady_clock::now() - start;
+		nanoseconds = elapsed.count();
+	}
+	record(counter, limbs, nanoseconds);
+}
+} // namespace LongArithm::stats
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Instrumentation is compiled in with -DLONGARITHM_STATS (`make STATS=1`)
+// Otherwise the macros below expand to nothing and cost nothing
+namespace LongArithm::stats {
+enum class Counter : size_t {
+	// `LongNumber` operations, integer operands included
+	Add,
+	Subtract,
+	Multiply,
+	Divide,
+	Shift,
+	Power,
+	Root,
+	ToString,
+	FromString,
+	// Kernel tiers
+	MulSchoolbook,
+	MulKaratsuba,
+	MulToom3,
+	MulNTT,
+	SqrSchoolbook,
+	SqrKaratsuba,
+	SqrToom3,
+	SqrNTT,
+	DivKnuth,
+	DivNewton,
+	ToDecimal,
+	FromDecimal,
+	// Heap blocks of limbs (see `poolAllocate`), no time
+	Allocation,
+	Count
+};
+
+struct Entry {
+	const char *name;
+	uint64_t calls;
+	uint64_t limbs;
+	uint64_t nanoseconds;
+};
+
+// True if the instrumentation is compiled in
+bool enabled(void);
+// Counters of every thread combined
+std::vector<Entry> snapshot(void);
+void reset(void);
+// Table of the counters that were hit
+// Time is inclusive, kernels run inside of operations
+void dump(std::ostream &out);
+
+void record(Counter counter, size_t limbs, uint64_t nanoseconds = 0);
+
+// Times its own lifetime. Recursive calls of the same counter only count
+// calls and limbs so that time is not added up twice
+class Timer {
+  private:
+	Counter counter;
+	size_t limbs;
+	bool outermost;
+	std::chrono::steady_clock::time_point start;
+
+  public:
+	Timer(Counter counter, size_t limbs);
+	~Timer();
+	Timer(const Timer &) = delete;
+	Timer &operator=(const Timer &) = delete;
+};
+} // namespace LongArithm::stats
+
+#ifdef LONGARITHM_STATS
+// Times the rest of the enclosing scope
+#define STATS_TIME(counter, limbs)                                           \
+	::LongArithm::stats::Timer statsTimer(                                   \
+		::LongArithm::stats::Counter::counter, limbs                         \
+	)
+#define STATS_COUNT(counter, limbs)                                          \
+	::LongArithm::stats::record(::LongArithm::stats::Counter::counter, limbs)
+#else
+#define STATS_TIME(counter, limbs)
+#define STATS_COUNT(counter, limbs)
+#endif
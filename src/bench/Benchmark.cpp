@@ -0,0 +1,136 @@
+#include "Benchmark.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace bench {
+namespace {
+constexpr uint64_t maxIterations = 1'000'000'000;
+
+// 1234.5 -> "1.23 us"
+std::string formatTime(double ns) {
+	const char *units[] = {"ns", "us", "ms", "s"};
+	int unit = 0;
+	for (; unit < 3 && ns >= 1000; unit++) ns /= 1000;
+	std::ostringstream output;
+	output << std::fixed << std::setprecision(ns < 10 ? 2 : 1) << ns << ' '
+		   << units[unit];
+	return output.str();
+}
+} // namespace
+
+State::State(size_t limbs, uint64_t iterations)
+	: remaining(iterations), limbs(limbs), iterations(iterations) {}
+
+bool State::keepRunning(void) {
+	if (!started) {
+		started = true;
+		cpuStart = std::clock();
+		wallStart = std::chrono::steady_clock::now();
+	}
+	if (remaining > 0) {
+		remaining--;
+		return true;
+	}
+	std::chrono::duration<double> wall =
+		std::chrono::steady_clock::now() - wallStart;
+	wallSeconds = wall.count();
+	cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+	return false;
+}
+
+void Runner::registerBenchmark(
+	const std::string &name, Function function, size_t maxLimbs
+) {
+	benchmarks.push_back({name, function, maxLimbs});
+}
+
+std::vector<Result> Runner::runBenchmarks(void) {
+	std::vector<Result> results;
+	printHeader();
+	for (const Benchmark &benchmark : benchmarks) {
+		if (benchmark.name.find(filter) == std::string::npos) continue;
+		for (size_t limbs : sizes) {
+			if (limbs > std::min(maxLimbs, benchmark.maxLimbs)) break;
+			results.push_back(run(benchmark, limbs));
+			printResult(results.back(), results.size() == 1);
+		}
+	}
+	printFooter();
+	return results;
+}
+
+// Starts with a single iteration and grows the count until the run takes
+// at least `minSeconds` (the same way Google Benchmark does)
+Result Runner::run(const Benchmark &benchmark, size_t limbs) const {
+	uint64_t iterations = 1;
+	while (true) {
+		State state(limbs, iterations);
+		benchmark.function(state);
+		if (state.wallSeconds >= minSeconds || iterations >= maxIterations) {
+			return {
+				benchmark.name + '/' + std::to_string(limbs), limbs,
+				iterations, state.wallSeconds * 1e9 / iterations,
+				state.cpuSeconds * 1e9 / iterations
+			};
+		}
+		// Aim past `minSeconds`, short runs are too noisy to extrapolate
+		double multiplier = state.wallSeconds > minSeconds / 10
+								? minSeconds * 1.4 / state.wallSeconds
+								: 10;
+		iterations = std::min(
+			maxIterations,
+			std::max<uint64_t>(iterations * multiplier, iterations + 1)
+		);
+	}
+}
+
+void Runner::printHeader(void) const {
+	switch (format) {
+	case Format::Table:
+		std::cout << std::left << std::setw(28) << "Benchmark" << std::right
+				  << std::setw(14) << "Wall" << std::setw(14) << "CPU"
+				  << std::setw(14) << "Iterations" << '\n'
+				  << std::string(70, '-') << '\n';
+		break;
+	case Format::CSV:
+		std::cout << "name,limbs,iterations,wall_ns,cpu_ns\n";
+		break;
+	case Format::JSON:
+		std::cout << "{\n  \"benchmarks\": [";
+		break;
+	}
+}
+
+void Runner::printResult(const Result &result, bool first) const {
+	switch (format) {
+	case Format::Table:
+		std::cout << std::left << std::setw(28) << result.name << std::right
+				  << std::setw(14) << formatTime(result.wallNs)
+				  << std::setw(14) << formatTime(result.cpuNs)
+				  << std::setw(14) << result.iterations << std::endl;
+		break;
+	case Format::CSV:
+		std::cout << result.name << ',' << result.limbs << ','
+				  << result.iterations << ',' << std::fixed
+				  << std::setprecision(1) << result.wallNs << ','
+				  << result.cpuNs << std::endl;
+		break;
+	case Format::JSON:
+		// Field names follow Google Benchmark
+		std::cout << (first ? "\n" : ",\n") << "    {\"name\": \""
+				  << result.name << "\", \"limbs\": " << result.limbs
+				  << ", \"iterations\": " << result.iterations
+				  << ", \"real_time\": " << std::fixed
+				  << std::setprecision(1) << result.wallNs
+				  << ", \"cpu_time\": " << result.cpuNs
+				  << ", \"time_unit\": \"ns\"}" << std::flush;
+		break;
+	}
+}
+
+void Runner::printFooter(void) const {
+	if (format == Format::JSON) std::cout << "\n  ]\n}\n";
+}
+} // namespace bench
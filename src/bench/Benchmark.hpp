@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench {
+// Keeps `value` from being optimized away
+template <typename T> void doNotOptimize(const T &value) {
+	asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Passed to every benchmark, only the loop is timed
+// while (state.keepRunning()) { ... }
+class State {
+  private:
+	uint64_t remaining;
+	bool started = false;
+	std::chrono::steady_clock::time_point wallStart;
+	std::clock_t cpuStart = 0;
+
+  public:
+	const size_t limbs;
+	const uint64_t iterations;
+	double wallSeconds = 0;
+	double cpuSeconds = 0;
+
+	State(size_t limbs, uint64_t iterations);
+	bool keepRunning(void);
+};
+
+struct Result {
+	std::string name;
+	size_t limbs;
+	uint64_t iterations;
+	double wallNs; // Per iteration
+	double cpuNs;
+};
+
+class Runner {
+  public:
+	using Function = std::function<void(State &)>;
+	enum class Format { Table, CSV, JSON };
+
+	// Benchmarks run once per size, up to `maxLimbs`
+	std::vector<size_t> sizes;
+	size_t maxLimbs = SIZE_MAX;
+	// Runs are repeated with more iterations until they take this long
+	double minSeconds = 0.2;
+	// Only benchmarks with names containing `filter` are run
+	std::string filter;
+	Format format = Format::Table;
+
+	void registerBenchmark(
+		const std::string &name, Function function,
+		size_t maxLimbs = SIZE_MAX
+	);
+	// Results are printed to `std::cout` as they come
+	std::vector<Result> runBenchmarks(void);
+
+  private:
+	struct Benchmark {
+		std::string name;
+		Function function;
+		size_t maxLimbs;
+	};
+	std::vector<Benchmark> benchmarks;
+
+	Result run(const Benchmark &benchmark, size_t limbs) const;
+	void printHeader(void) const;
+	void printResult(const Result &result, bool first) const;
+	void printFooter(void) const;
+};
+} // namespace bench
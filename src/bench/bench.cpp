@@ -0,0 +1,163 @@
+#include "../LongArithm.hpp"
+#include "Benchmark.hpp"
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <map>
+#include <random>
+
+using namespace LongArithm;
+
+namespace {
+// Random integer with exactly `limbs` chunks, cached between runs
+const LongNumber &randomNumber(size_t limbs, unsigned seed = 1) {
+	static std::map<std::pair<size_t, unsigned>, LongNumber> cache;
+	auto found = cache.find({limbs, seed});
+	if (found != cache.end()) return found->second;
+
+	std::mt19937 random(seed * 1000003 + limbs);
+	std::string bits(32 * limbs, '0');
+	bits[0] = '1';
+	for (size_t i = 1; i < bits.size(); i++) bits[i] += random() & 1;
+	return cache.emplace(std::pair(limbs, seed), LongNumber(bits, 0))
+		.first->second;
+}
+
+void registerBenchmarks(bench::Runner &runner) {
+	using bench::State, bench::doNotOptimize;
+	runner.registerBenchmark("add", [](State &state) {
+		const LongNumber &a = randomNumber(state.limbs, 1);
+		const LongNumber &b = randomNumber(state.limbs, 2);
+		while (state.keepRunning()) doNotOptimize(a + b);
+	});
+	runner.registerBenchmark("sub", [](State &state) {
+		const LongNumber &a = randomNumber(state.limbs, 1);
+		const LongNumber &b = randomNumber(state.limbs, 2);
+		while (state.keepRunning()) doNotOptimize(a - b);
+	});
+	runner.registerBenchmark("mul", [](State &state) {
+		const LongNumber &a = randomNumber(state.limbs, 1);
+		const LongNumber &b = randomNumber(state.limbs, 2);
+		while (state.keepRunning()) doNotOptimize(a * b);
+	});
+	// Thread scaling of the multiplication, 1, 2, 4, ... up to the thread
+	// count given with `--threads`
+	unsigned maxThreads = getThreadCount();
+	for (unsigned threads = 1;; threads = std::min(2 * threads, maxThreads)) {
+		std::string name = "mul/threads:" + std::to_string(threads);
+		runner.registerBenchmark(name, [threads](State &state) {
+			const LongNumber &a = randomNumber(state.limbs, 1);
+			const LongNumber &b = randomNumber(state.limbs, 2);
+			unsigned saved = getThreadCount();
+			setThreadCount(threads);
+			while (state.keepRunning()) doNotOptimize(a * b);
+			setThreadCount(saved);
+		});
+		if (threads == maxThreads) break;
+	}
+	// Numerator is twice as long as the denominator
+	runner.registerBenchmark("div", [](State &state) {
+		const LongNumber &a = randomNumber(2 * state.limbs, 1);
+		const LongNumber &b = randomNumber(state.limbs, 2);
+		while (state.keepRunning()) doNotOptimize(a / b);
+	});
+	// Number in [0, 1) with `limbs` chunks of precision
+	runner.registerBenchmark("sqrt", [](State &state) {
+		uint32_t bits = 32 * state.limbs;
+		LongNumber x = randomNumber(state.limbs).withPrecision(bits) >> bits;
+		while (state.keepRunning()) doNotOptimize(x.sqrt());
+	});
+	runner.registerBenchmark("pow5", [](State &state) {
+		const LongNumber &a = randomNumber(state.limbs);
+		while (state.keepRunning()) doNotOptimize(a.pow(5));
+	});
+	runner.registerBenchmark("shl", [](State &state) {
+		const LongNumber &a = randomNumber(state.limbs);
+		while (state.keepRunning()) doNotOptimize(a << 37);
+	});
+	runner.registerBenchmark("shr", [](State &state) {
+		const LongNumber &a = randomNumber(state.limbs);
+		while (state.keepRunning()) doNotOptimize(a >> 37);
+	});
+	runner.registerBenchmark("toString", [](State &state) {
+		const LongNumber &a = randomNumber(state.limbs);
+		while (state.keepRunning()) doNotOptimize(a.toString());
+	});
+	runner.registerBenchmark("fromDecimalString", [](State &state) {
+		std::string digits = randomNumber(state.limbs).toString();
+		while (state.keepRunning())
+			doNotOptimize(LongNumber::fromDecimalString(digits, 0));
+	});
+}
+
+// Returns 0 if `arg` is not a positive integer
+size_t parseCount(const std::string &arg, const std::string &name) {
+	size_t count = 0;
+	const char *end = arg.data() + arg.size();
+	auto [last, error] = std::from_chars(arg.data(), end, count);
+	if (error != std::errc() || last != end || count == 0) {
+		std::cerr << "Invalid " << name << ": " << arg << '\n';
+		return 0;
+	}
+	return count;
+}
+} // namespace
+
+// Usage: bench [--format table|csv|json] [--filter NAME] [--max-limbs N]
+//              [--min-time SECONDS] [--threads N]
+//              [--cpu generic|bmi2|avx2|avx512]
+int main(int argc, char **argv) {
+	bench::Runner runner;
+	// Every kernel crossover lies between 1 and 10^6 limbs
+	runner.sizes = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+	for (int i = 1; i < argc; i++) {
+		const std::string option = argv[i];
+		if (i + 1 == argc) {
+			std::cerr << "Missing value for option: " << option << '\n';
+			return 1;
+		}
+		const std::string value = argv[++i];
+		if (option == "--format") {
+			if (value == "table")
+				runner.format = bench::Runner::Format::Table;
+			else if (value == "csv")
+				runner.format = bench::Runner::Format::CSV;
+			else if (value == "json")
+				runner.format = bench::Runner::Format::JSON;
+			else {
+				std::cerr << "Unknown format: " << value << '\n';
+				return 1;
+			}
+		} else if (option == "--filter") {
+			runner.filter = value;
+		} else if (option == "--max-limbs") {
+			runner.maxLimbs = parseCount(value, "limb count");
+			if (runner.maxLimbs == 0) return 1;
+		} else if (option == "--min-time") {
+			runner.minSeconds = std::atof(value.c_str());
+			if (runner.minSeconds <= 0) {
+				std::cerr << "Minimum time must be > 0\n";
+				return 1;
+			}
+		} else if (option == "--threads") {
+			size_t threads = parseCount(value, "thread count");
+			if (threads == 0) return 1;
+			setThreadCount(threads);
+		} else if (option == "--cpu") {
+			std::optional<CpuTier> tier = parseCpuTier(value);
+			if (!tier || *tier > detectCpuTier()) {
+				std::cerr << "Unsupported CPU tier: " << value << '\n';
+				return 1;
+			}
+			setCpuTier(*tier);
+		} else {
+			std::cerr << "Unknown option: " << option << '\n';
+			return 1;
+		}
+	}
+
+	registerBenchmarks(runner);
+	runner.runBenchmarks();
+	return 0;
+}
@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <spawn.h>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char **environ;
+
+namespace {
+struct Measurement {
+	uint32_t digits;
+	double wallMs;
+	double cpuMs;
+	long peakRssKiB;
+};
+
+struct Options {
+	std::string pi = "build/calc-pi";
+	std::string baseline = "src/bench/pi-baseline.csv";
+	std::vector<uint32_t> digits;
+	unsigned runs = 5;
+	unsigned threads = 1;
+	// Allowed slowdown is `tolerance * baseline + slack`
+	double timeTolerance = 0.10;
+	double timeSlackMs = 5;
+	double rssTolerance = 0.10;
+	double rssSlackKiB = 1024;
+	bool update = false;
+};
+
+// Runs `calc-pi <digits> --threads <threads>` with the output discarded
+std::optional<Measurement> measure(const Options &options, uint32_t digits) {
+	std::string digitsArg = std::to_string(digits);
+	std::string threadsArg = std::to_string(options.threads);
+	std::string threadsOption = "--threads";
+	std::string pi = options.pi;
+	char *args[] = {
+		pi.data(), digitsArg.data(), threadsOption.data(), threadsArg.data(),
+		nullptr
+	};
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_addopen(
+		&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0
+	);
+
+	auto start = std::chrono::steady_clock::now();
+	pid_t pid;
+	int error =
+		posix_spawn(&pid, pi.c_str(), &actions, nullptr, args, environ);
+	posix_spawn_file_actions_destroy(&actions);
+	if (error != 0) {
+		std::cerr << "Failed to start " << pi << '\n';
+		return std::nullopt;
+	}
+	int status;
+	rusage usage;
+	wait4(pid, &status, 0, &usage);
+	std::chrono::duration<double, std::milli> wall =
+		std::chrono::steady_clock::now() - start;
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		std::cerr << pi << ' ' << digits << " failed\n";
+		return std::nullopt;
+	}
+
+	auto toMs = [](const timeval &time) {
+		return time.tv_sec * 1e3 + time.tv_usec / 1e3;
+	};
+	// `ru_maxrss` is in KiB on Linux
+	return Measurement{
+		digits, wall.count(), toMs(usage.ru_utime) + toMs(usage.ru_stime),
+		usage.ru_maxrss
+	};
+}
+
+// Best of `options.runs`, the minimum is the least noisy estimate
+std::optional<Measurement>
+measureBest(const Options &options, uint32_t digits) {
+	std::optional<Measurement> best;
+	for (unsigned run = 0; run < options.runs; run++) {
+		std::optional<Measurement> current = measure(options, digits);
+		if (!current) return std::nullopt;
+		if (!best) {
+			best = current;
+			continue;
+		}
+		best->wallMs = std::min(best->wallMs, current->wallMs);
+		best->cpuMs = std::min(best->cpuMs, current->cpuMs);
+		best->peakRssKiB = std::min(best->peakRssKiB, current->peakRssKiB);
+	}
+	return best;
+}
+
+// CSV with a header, lines starting with '#' are comments
+std::optional<std::vector<Measurement>>
+readBaseline(const std::string &path) {
+	std::ifstream file(path);
+	if (!file) return std::nullopt;
+	std::vector<Measurement> baseline;
+	std::string line;
+	bool header = true;
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#') continue;
+		if (header) {
+			header = false;
+			continue;
+		}
+		Measurement entry;
+		char comma;
+		std::istringstream fields(line);
+		if (!(fields >> entry.digits >> comma >> entry.wallMs >> comma >>
+			  entry.cpuMs >> comma >> entry.peakRssKiB)) {
+			std::cerr << "Malformed baseline line: " << line << '\n';
+			return std::nullopt;
+		}
+		baseline.push_back(entry);
+	}
+	return baseline;
+}
+
+bool writeBaseline(
+	const std::string &path, const std::vector<Measurement> &measurements
+) {
+	std::ofstream file(path);
+	if (!file) return false;
+	file << "# calc-pi baseline, regenerate with `make pi.baseline`\n"
+		 << "digits,wall_ms,cpu_ms,peak_rss_kib\n"
+		 << std::fixed << std::setprecision(1);
+	for (const Measurement &entry : measurements)
+		file << entry.digits << ',' << entry.wallMs << ',' << entry.cpuMs
+			 << ',' << entry.peakRssKiB << '\n';
+	return static_cast<bool>(file);
+}
+
+// Prints one row of the diff table, returns true if `current` regressed
+bool compare(
+	uint32_t digits, const std::string &metric, double base, double current,
+	double tolerance, double slack
+) {
+	bool regressed = current > base * (1 + tolerance) + slack;
+	double change = base > 0 ? (current - base) / base * 100 : 0;
+	std::cout << std::setw(10) << digits << "  " << std::left
+			  << std::setw(14) << metric << std::right << std::fixed
+			  << std::setprecision(1) << std::setw(12) << base
+			  << std::setw(12) << current << std::setw(9)
+			  << std::showpos << change << '%' << std::noshowpos << "  "
+			  << (regressed ? "REGRESSED" : "ok") << '\n';
+	return regressed;
+}
+
+// Returns 0 if `arg` is not a positive integer
+unsigned parseCount(const std::string &arg, const std::string &name) {
+	unsigned count = 0;
+	const char *end = arg.data() + arg.size();
+	auto [last, error] = std::from_chars(arg.data(), end, count);
+	if (error != std::errc() || last != end || count == 0) {
+		std::cerr << "Invalid " << name << ": " << arg << '\n';
+		return 0;
+	}
+	return count;
+}
+
+// Stores `arg` in `value`, returns false if it is not a number >= 0
+bool parseNonNegative(
+	const std::string &arg, const std::string &name, double &value
+) {
+	double parsed = 0;
+	const char *end = arg.data() + arg.size();
+	auto [last, error] = std::from_chars(arg.data(), end, parsed);
+	if (error != std::errc() || last != end || !(parsed >= 0)) {
+		std::cerr << "Invalid " << name << ": " << arg << '\n';
+		return false;
+	}
+	value = parsed;
+	return true;
+}
+
+// "1000,10000" -> {1000, 10000}, empty on error
+std::vector<uint32_t> parseDigits(const std::string &arg) {
+	std::vector<uint32_t> digits;
+	std::istringstream list(arg);
+	std::string item;
+	while (std::getline(list, item, ',')) {
+		unsigned count = parseCount(item, "digit count");
+		if (count == 0) return {};
+		digits.push_back(count);
+	}
+	return digits;
+}
+} // namespace
+
+// Usage: pi-regression [--pi PATH] [--baseline PATH] [--digits N,N,...]
+//                      [--runs N] [--threads N] [--time-tolerance F]
+//                      [--time-slack MS] [--rss-tolerance F]
+//                      [--rss-slack KIB] [--update]
+// Compares calc-pi against the baseline, exits with 1 on a regression
+// With `--update` the baseline is overwritten with new measurements
+int main(int argc, char **argv) {
+	Options options;
+	for (int i = 1; i < argc; i++) {
+		const std::string option = argv[i];
+		if (option == "--update") {
+			options.update = true;
+			continue;
+		}
+		if (i + 1 == argc) {
+			std::cerr << "Missing value for option: " << option << '\n';
+			return 1;
+		}
+		const std::string value = argv[++i];
+		bool valid = true;
+		if (option == "--pi")
+			options.pi = value;
+		else if (option == "--baseline")
+			options.baseline = value;
+		else if (option == "--digits")
+			valid = !(options.digits = parseDigits(value)).empty();
+		else if (option == "--runs")
+			valid = (options.runs = parseCount(value, "run count")) != 0;
+		else if (option == "--threads")
+			valid = (options.threads = parseCount(value, "thread count")) != 0;
+		else if (option == "--time-tolerance")
+			valid = parseNonNegative(value, "tolerance", options.timeTolerance);
+		else if (option == "--time-slack")
+			valid = parseNonNegative(value, "slack", options.timeSlackMs);
+		else if (option == "--rss-tolerance")
+			valid = parseNonNegative(value, "tolerance", options.rssTolerance);
+		else if (option == "--rss-slack")
+			valid = parseNonNegative(value, "slack", options.rssSlackKiB);
+		else {
+			std::cerr << "Unknown option: " << option << '\n';
+			return 1;
+		}
+		if (!valid) return 1;
+	}
+
+	std::vector<Measurement> baseline;
+	if (!options.update) {
+		std::optional<std::vector<Measurement>> stored =
+			readBaseline(options.baseline);
+		if (!stored) {
+			std::cerr << "Failed to read baseline " << options.baseline
+					  << '\n';
+			return 1;
+		}
+		baseline = *stored;
+		if (options.digits.empty())
+			for (const Measurement &entry : baseline)
+				options.digits.push_back(entry.digits);
+	} else if (options.digits.empty()) {
+		options.digits = {1000, 10000, 100000, 1000000};
+	}
+
+	std::vector<Measurement> measurements;
+	for (uint32_t digits : options.digits) {
+		std::optional<Measurement> best = measureBest(options, digits);
+		if (!best) return 1;
+		measurements.push_back(*best);
+	}
+
+	if (options.update) {
+		if (!writeBaseline(options.baseline, measurements)) {
+			std::cerr << "Failed to write baseline " << options.baseline
+					  << '\n';
+			return 1;
+		}
+		std::cout << "Baseline written to " << options.baseline << '\n';
+		return 0;
+	}
+
+	std::cout << std::setw(10) << "Digits" << "  " << std::left
+			  << std::setw(14) << "Metric" << std::right << std::setw(12)
+			  << "Baseline" << std::setw(12) << "Current" << std::setw(10)
+			  << "Change" << '\n'
+			  << std::string(69, '-') << '\n';
+	bool regressed = false;
+	for (const Measurement &current : measurements) {
+		auto base = std::find_if(
+			baseline.begin(), baseline.end(),
+			[&](const Measurement &entry) {
+				return entry.digits == current.digits;
+			}
+		);
+		if (base == baseline.end()) {
+			std::cerr << "No baseline for " << current.digits << " digits\n";
+			return 1;
+		}
+		regressed |= compare(
+			current.digits, "wall ms", base->wallMs, current.wallMs,
+			options.timeTolerance, options.timeSlackMs
+		);
+		regressed |= compare(
+			current.digits, "cpu ms", base->cpuMs, current.cpuMs,
+			options.timeTolerance, options.timeSlackMs
+		);
+		regressed |= compare(
+			current.digits, "peak rss KiB", base->peakRssKiB,
+			current.peakRssKiB, options.rssTolerance, options.rssSlackKiB
+		);
+	}
+	if (regressed) std::cout << "\nPerformance regressed\n";
+	return regressed ? 1 : 0;
+}
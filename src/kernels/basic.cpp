@@ -0,0 +1,255 @@
+#include <algorithm>
+
+#include "kernels.hpp"
+
+namespace LongArithm::kernels {
+namespace {
+// Vector kernels leave shorter operands to the portable loops
+constexpr size_t vectorMinLimbs = 16;
+} // namespace
+
+// *BASIC UTILS*
+
+size_t normalizedSize(const uint32_t *a, size_t n) {
+	while (n > 0 && a[n - 1] == 0) n--;
+	return n;
+}
+
+size_t lowZeroCount(const uint32_t *a, size_t n) {
+	size_t count = 0;
+	while (count < n && a[count] == 0) count++;
+	return count;
+}
+
+void normalize(Limbs &a) {
+	while (!a.empty() && a.back() == 0) a.pop_back();
+}
+
+int compare(const uint32_t *a, size_t an, const uint32_t *b, size_t bn) {
+	an = normalizedSize(a, an);
+	bn = normalizedSize(b, bn);
+	if (an != bn) return an < bn ? -1 : 1;
+	return compareN(a, b, an);
+}
+
+int compareN(const uint32_t *a, const uint32_t *b, size_t n) {
+#if defined(__x86_64__)
+	// Equal blocks of 4 limbs are skipped with one SSE2 comparison
+	while (n >= 4) {
+		__m128i x =
+			_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + n - 4));
+		__m128i y =
+			_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + n - 4));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(x, y)) != 0xFFFF) break;
+		n -= 4;
+	}
+#endif
+	for (size_t i = n; i-- > 0;) {
+		if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+	}
+	return 0;
+}
+
+// *ADDITION/SUBTRACTION*
+
+uint32_t addN(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n) {
+	if (n < vectorMinLimbs) return addNGeneric(r, a, b, n);
+	return kernelTable().addN(r, a, b, n);
+}
+
+uint32_t subN(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n) {
+	if (n < vectorMinLimbs) return subNGeneric(r, a, b, n);
+	return kernelTable().subN(r, a, b, n);
+}
+
+uint32_t
+addNGeneric(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n) {
+	unsigned char carry = 0;
+	size_t i = 0;
+	for (; i + 1 < n; i += 2) {
+		uint64_t sum;
+		carry = addCarry(carry, load64(a + i), load64(b + i), sum);
+		store64(r + i, sum);
+	}
+	if (i < n) {
+		uint64_t sum = static_cast<uint64_t>(a[i]) + b[i] + carry;
+		r[i] = static_cast<uint32_t>(sum);
+		carry = static_cast<unsigned char>(sum >> 32);
+	}
+	return carry;
+}
+
+uint32_t
+subNGeneric(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n) {
+	unsigned char borrow = 0;
+	size_t i = 0;
+	for (; i + 1 < n; i += 2) {
+		uint64_t diff;
+		borrow = subBorrow(borrow, load64(a + i), load64(b + i), diff);
+		store64(r + i, diff);
+	}
+	if (i < n) {
+		uint64_t diff = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+		r[i] = static_cast<uint32_t>(diff);
+		// Wrapped around => top half is all ones
+		borrow = static_cast<unsigned char>(diff >> 63);
+	}
+	return borrow;
+}
+
+uint32_t
+add(uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn) {
+	uint32_t carry = addN(r, a, b, bn);
+	for (size_t i = bn; i < an; i++) {
+		uint64_t sum = static_cast<uint64_t>(a[i]) + carry;
+		r[i] = static_cast<uint32_t>(sum);
+		carry = static_cast<uint32_t>(sum >> 32);
+	}
+	return carry;
+}
+
+uint32_t
+sub(uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn) {
+	uint32_t borrow = subN(r, a, b, bn);
+	for (size_t i = bn; i < an; i++) {
+		r[i] = a[i] - borrow;
+		borrow = borrow && a[i] == 0;
+	}
+	return borrow;
+}
+
+uint32_t addInPlace(uint32_t *r, size_t rn, const uint32_t *a, size_t an) {
+	uint32_t carry = addN(r, r, a, an);
+	for (size_t i = an; carry && i < rn; i++) carry = ++r[i] == 0;
+	return carry;
+}
+
+uint32_t subInPlace(uint32_t *r, size_t rn, const uint32_t *a, size_t an) {
+	uint32_t borrow = subN(r, r, a, an);
+	for (size_t i = an; borrow && i < rn; i++) borrow = r[i]-- == 0;
+	return borrow;
+}
+
+void negate(uint32_t *r, size_t n) {
+	size_t i = lowZeroCount(r, n);
+	if (i == n) return;
+	r[i] = -r[i];
+	for (i++; i < n; i++) r[i] = ~r[i];
+}
+
+uint32_t mulWord(uint32_t *r, const uint32_t *a, size_t n, uint32_t w) {
+	uint64_t carry = 0;
+	for (size_t i = 0; i < n; i++) {
+		carry += static_cast<uint64_t>(a[i]) * w;
+		r[i] = static_cast<uint32_t>(carry);
+		carry >>= 32;
+	}
+	return static_cast<uint32_t>(carry);
+}
+
+uint64_t mulDoubleWord(uint32_t *r, const uint32_t *a, size_t n, uint64_t w) {
+	uint128_t carry = 0;
+	for (size_t i = 0; i < n; i++) {
+		carry += static_cast<uint128_t>(a[i]) * w;
+		r[i] = static_cast<uint32_t>(carry);
+		carry >>= 32;
+	}
+	return static_cast<uint64_t>(carry);
+}
+
+uint32_t addMulWord(uint32_t *r, const uint32_t *a, size_t n, uint32_t w) {
+	uint64_t carry = 0;
+	for (size_t i = 0; i < n; i++) {
+		carry += static_cast<uint64_t>(a[i]) * w + r[i];
+		r[i] = static_cast<uint32_t>(carry);
+		carry >>= 32;
+	}
+	return static_cast<uint32_t>(carry);
+}
+
+uint64_t addMulWord64(uint64_t *r, const uint64_t *a, size_t n, uint64_t w) {
+	return kernelTable().addMulWord64(r, a, n, w);
+}
+
+uint64_t
+addMulWord64Generic(uint64_t *r, const uint64_t *a, size_t n, uint64_t w) {
+	uint64_t carry = 0;
+	for (size_t i = 0; i < n; i++) {
+		uint64_t high, low = mulWide(a[i], w, high);
+		high += addCarry(0, low, carry, low);
+		high += addCarry(0, low, r[i], low);
+		r[i] = low;
+		carry = high;
+	}
+	return carry;
+}
+
+uint32_t subMulWord(uint32_t *r, const uint32_t *a, size_t n, uint32_t w) {
+	uint64_t carry = 0;
+	for (size_t i = 0; i < n; i++) {
+		uint64_t product = static_cast<uint64_t>(a[i]) * w + carry;
+		uint32_t low = static_cast<uint32_t>(product);
+		carry = (product >> 32) + (r[i] < low);
+		r[i] -= low;
+	}
+	return static_cast<uint32_t>(carry);
+}
+
+// *SHIFTS*
+
+uint32_t shiftLeft(uint32_t *r, const uint32_t *a, size_t n, unsigned shift) {
+	if (shift == 0 || n < vectorMinLimbs)
+		return shiftLeftGeneric(r, a, n, shift);
+	return kernelTable().shiftLeft(r, a, n, shift);
+}
+
+uint32_t shiftRight(uint32_t *r, const uint32_t *a, size_t n, unsigned shift) {
+	if (shift == 0 || n < vectorMinLimbs)
+		return shiftRightGeneric(r, a, n, shift);
+	return kernelTable().shiftRight(r, a, n, shift);
+}
+
+uint32_t
+shiftLeftGeneric(uint32_t *r, const uint32_t *a, size_t n, unsigned shift) {
+	if (shift == 0) {
+		std::copy(a, a + n, r);
+		return 0;
+	}
+	uint64_t carry = 0;
+	size_t i = 0;
+	for (; i + 1 < n; i += 2) {
+		uint64_t word = load64(a + i);
+		store64(r + i, (word << shift) | carry);
+		carry = word >> (64 - shift);
+	}
+	if (i < n) {
+		uint32_t limb = a[i];
+		r[i] = (limb << shift) | static_cast<uint32_t>(carry);
+		carry = limb >> (32 - shift);
+	}
+	return static_cast<uint32_t>(carry);
+}
+
+uint32_t
+shiftRightGeneric(uint32_t *r, const uint32_t *a, size_t n, unsigned shift) {
+	if (shift == 0) {
+		std::copy(a, a + n, r);
+		return 0;
+	}
+	// Odd top limb first so that the rest splits into pairs
+	uint64_t carry = 0;
+	size_t i = n;
+	if (i % 2) {
+		uint32_t limb = a[--i];
+		r[i] = limb >> shift;
+		carry = static_cast<uint64_t>(limb) << (64 - shift);
+	}
+	while (i > 0) {
+		i -= 2;
+		uint64_t word = load64(a + i);
+		store64(r + i, (word >> shift) | carry);
+		carry = word << (64 - shift);
+	}
+	return static_cast<uint32_t>(carry >> 32);
+}
+} // namespace LongArithm::kernels
@@ -0,0 +1,88 @@
+#include <array>
+#include <atomic>
+#include <stdexcept>
+
+#include "../LongArithm.hpp"
+#include "kernels.hpp"
+
+namespace LongArithm {
+
+namespace {
+constexpr std::array<std::string_view, 4> tierNames = {
+	"generic", "bmi2", "avx2", "avx512"
+};
+
+// Indexed by `CpuTier`, later tiers reuse the kernels of earlier ones
+// where they have nothing better
+constexpr kernels::KernelTable tables[] = {
+	{kernels::addNGeneric, kernels::subNGeneric, kernels::addMulWord64Generic,
+	 kernels::shiftLeftGeneric, kernels::shiftRightGeneric},
+#if defined(__x86_64__)
+	{kernels::addNGeneric, kernels::subNGeneric, kernels::addMulWord64BMI2,
+	 kernels::shiftLeftGeneric, kernels::shiftRightGeneric},
+	{kernels::addNAVX2, kernels::subNAVX2, kernels::addMulWord64BMI2,
+	 kernels::shiftLeftAVX2, kernels::shiftRightAVX2},
+	{kernels::addNAVX512, kernels::subNAVX512, kernels::addMulWord64BMI2,
+	 kernels::shiftLeftAVX2, kernels::shiftRightAVX2},
+#endif
+};
+
+// Set on first use, so that detection runs before any kernel
+std::atomic<const kernels::KernelTable *> activeTable = nullptr;
+
+const kernels::KernelTable *tableOf(CpuTier tier) {
+	return &tables[static_cast<size_t>(tier)];
+}
+} // namespace
+
+CpuTier detectCpuTier(void) {
+#if defined(__x86_64__)
+	static const CpuTier detected = []() {
+		__builtin_cpu_init();
+		if (!__builtin_cpu_supports("bmi2") || !__builtin_cpu_supports("adx"))
+			return CpuTier::Generic;
+		if (!__builtin_cpu_supports("avx2")) return CpuTier::BMI2;
+		if (!__builtin_cpu_supports("avx512f")) return CpuTier::AVX2;
+		return CpuTier::AVX512;
+	}();
+	return detected;
+#else
+	return CpuTier::Generic;
+#endif
+}
+
+void setCpuTier(CpuTier tier) {
+	if (tier < CpuTier::Generic || tier > detectCpuTier())
+		throw std::invalid_argument("CPU does not support the kernel tier");
+	activeTable = tableOf(tier);
+}
+
+CpuTier getCpuTier(void) {
+	const kernels::KernelTable *table = &kernels::kernelTable();
+	return static_cast<CpuTier>(table - tables);
+}
+
+std::string_view cpuTierName(CpuTier tier) {
+	return tierNames.at(static_cast<size_t>(tier));
+}
+
+std::optional<CpuTier> parseCpuTier(std::string_view name) {
+	for (size_t i = 0; i < tierNames.size(); i++)
+		if (tierNames[i] == name) return static_cast<CpuTier>(i);
+	return std::nullopt;
+}
+
+namespace kernels {
+
+// *CPU DISPATCH*
+
+const KernelTable &kernelTable(void) {
+	const KernelTable *table = activeTable.load(std::memory_order_relaxed);
+	if (table == nullptr) {
+		table = tableOf(detectCpuTier());
+		activeTable.store(table, std::memory_order_relaxed);
+	}
+	return *table;
+}
+} // namespace kernels
+} // namespace LongArithm
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+#include "../Stats.hpp"
+#include "kernels.hpp"
+
+namespace LongArithm::kernels {
+
+namespace {
+// Newton-Raphson division is used when both the divisor and the quotient
+// have at least this many limbs, below that Knuth's algorithm is faster
+constexpr size_t newtonThreshold = 96;
+
+Limbs mulLimbs(const Limbs &a, const Limbs &b) {
+	Limbs result(a.size() + b.size());
+	mul(result.data(), a.data(), a.size(), b.data(), b.size());
+	normalize(result);
+	return result;
+}
+
+int compare(const Limbs &a, const Limbs &b) {
+	return kernels::compare(a.data(), a.size(), b.data(), b.size());
+}
+
+void increment(Limbs &a) {
+	const uint32_t one = 1;
+	a.push_back(0);
+	addInPlace(a.data(), a.size(), &one, 1);
+	normalize(a);
+}
+
+void decrement(Limbs &a) {
+	const uint32_t one = 1;
+	subInPlace(a.data(), a.size(), &one, 1);
+	normalize(a);
+}
+
+// a -= b, requires a >= b
+void subtract(Limbs &a, const Limbs &b) {
+	subInPlace(a.data(), a.size(), b.data(), b.size());
+	normalize(a);
+}
+
+// Returns an approximation of floor(B^(2n) / d) accurate to a few units
+// `d` has `n` limbs with a non zero top limb
+Limbs reciprocal(const uint32_t *d, size_t n) {
+	if (n < newtonThreshold) {
+		Limbs numerator(2 * n + 1, 0);
+		numerator.back() = 1;
+		Limbs x(n + 2);
+		divKnuth(x.data(), nullptr, numerator.data(), numerator.size(), d, n);
+		normalize(x);
+		return x;
+	}
+	// Reciprocal of the top `h` limbs is accurate to about `h` limbs
+	// A single Newton step doubles that, 3 extra limbs absorb the error
+	size_t h = n / 2 + 3;
+	Limbs xh = reciprocal(d + (n - h), h);
+
+	// x0 = xh * B^(n - h)
+	// x = x0 + x0 * (B^(2n) - d * x0) / B^(2n)
+	//   = x0 + xh * (B^(n + h) - d * xh) / B^(2h)
+	Limbs dxh(n + xh.size());
+	mul(dxh.data(), d, n, xh.data(), xh.size());
+	normalize(dxh);
+	Limbs error(n + h + 1, 0);
+	error.back() = 1;
+	bool negative = compare(dxh, error) > 0;
+	if (negative) {
+		subtract(dxh, error);
+		error = std::move(dxh);
+	} else {
+		subtract(error, dxh);
+	}
+
+	Limbs correction = mulLimbs(xh, error);
+	correction.erase(
+		correction.begin(),
+		correction.begin() + std::min(2 * h, correction.size())
+	);
+	Limbs x(n - h, 0);
+	x.insert(x.end(), xh.begin(), xh.end());
+	x.push_back(0);
+	if (negative)
+		subInPlace(x.data(), x.size(), correction.data(), correction.size());
+	else
+		addInPlace(x.data(), x.size(), correction.data(), correction.size());
+	normalize(x);
+	return x;
+}
+} // namespace
+
+uint32_t divWord(uint32_t *q, const uint32_t *a, size_t n, uint32_t d) {
+	uint64_t remainder = 0;
+	for (size_t i = n; i-- > 0;) {
+		uint64_t cur = (remainder << 32) | a[i];
+		q[i] = static_cast<uint32_t>(cur / d);
+		remainder = cur % d;
+	}
+	return static_cast<uint32_t>(remainder);
+}
+
+uint64_t divDoubleWord(uint32_t *q, const uint32_t *a, size_t n, uint64_t d) {
+	uint128_t remainder = 0;
+	for (size_t i = n; i-- > 0;) {
+		uint128_t cur = (remainder << 32) | a[i];
+		q[i] = static_cast<uint32_t>(cur / d);
+		remainder = cur % d;
+	}
+	return static_cast<uint64_t>(remainder);
+}
+
+// Implementation follows "Hacker's Delight" divmnu
+void divKnuth(
+	uint32_t *q, uint32_t *r, const uint32_t *n, size_t nn, const uint32_t *d,
+	size_t dn
+) {
+	STATS_TIME(DivKnuth, nn + dn);
+	if (dn == 1) {
+		uint32_t remainder = divWord(q, n, nn, d[0]);
+		if (r) r[0] = remainder;
+		return;
+	}
+	// Normalize so that the top bit of the divisor is set
+	unsigned shift = std::countl_zero(d[dn - 1]);
+	Limbs dNorm(dn), nNorm(nn + 1);
+	shiftLeft(dNorm.data(), d, dn, shift);
+	nNorm[nn] = shiftLeft(nNorm.data(), n, nn, shift);
+	const uint64_t dTop = dNorm[dn - 1], dNext = dNorm[dn - 2];
+
+	for (size_t j = nn - dn + 1; j-- > 0;) {
+		uint64_t top = (static_cast<uint64_t>(nNorm[j + dn]) << 32) |
+					   nNorm[j + dn - 1];
+		uint64_t qHat = top / dTop;
+		uint64_t rHat = top % dTop;
+		// Estimate is at most 2 too large, the check below fixes that
+		// in most of the cases
+		while ((qHat >> 32) ||
+			   qHat * dNext > ((rHat << 32) | nNorm[j + dn - 2])) {
+			qHat--;
+			rHat += dTop;
+			if (rHat >> 32) break;
+		}
+		uint32_t borrow = subMulWord(
+			nNorm.data() + j, dNorm.data(), dn, static_cast<uint32_t>(qHat)
+		);
+		uint32_t nTop = nNorm[j + dn];
+		nNorm[j + dn] = nTop - borrow;
+		if (nTop < borrow) {
+			// Rare case, estimate was still one too large
+			qHat--;
+			nNorm[j + dn] +=
+				addN(nNorm.data() + j, nNorm.data() + j, dNorm.data(), dn);
+		}
+		q[j] = static_cast<uint32_t>(qHat);
+	}
+	if (r) shiftRight(r, nNorm.data(), dn, shift);
+}
+
+// Quotient is estimated as n * X / B^(2 * size)
+// where X ~ B^(2 * size) / d is computed by `reciprocal`
+// and fixed by computing the exact remainder
+void divNewton(
+	uint32_t *q, uint32_t *r, const uint32_t *n, size_t nn, const uint32_t *d,
+	size_t dn
+) {
+	STATS_TIME(DivNewton, nn + dn);
+	size_t qn = nn - dn + 1;
+	// Divisor limbs past `qn + 1` do not affect the quotient much
+	size_t size = qn + 1;
+	Limbs scaledN, scaledD;
+	if (dn >= size) {
+		size_t skip = dn - size;
+		scaledN.assign(n + skip, n + nn);
+		scaledD.assign(d + skip, d + dn);
+	} else {
+		size_t pad = size - dn;
+		scaledN.assign(pad, 0);
+		scaledN.insert(scaledN.end(), n, n + nn);
+		scaledD.assign(pad, 0);
+		scaledD.insert(scaledD.end(), d, d + dn);
+	}
+	Limbs x = reciprocal(scaledD.data(), size);
+	Limbs quotient = mulLimbs(scaledN, x);
+	quotient.erase(
+		quotient.begin(), quotient.begin() + std::min(2 * size, quotient.size())
+	);
+
+	// Estimate is off by a few units at most
+	Limbs numerator(n, n + nn), divisor(d, d + dn);
+	normalize(numerator);
+	Limbs product = mulLimbs(quotient, divisor);
+	while (compare(product, numerator) > 0) {
+		decrement(quotient);
+		subtract(product, divisor);
+	}
+	subtract(numerator, product);
+	while (compare(numerator, divisor) >= 0) {
+		increment(quotient);
+		subtract(numerator, divisor);
+	}
+
+	assert(quotient.size() <= qn);
+	std::copy(quotient.begin(), quotient.end(), q);
+	std::fill(q + quotient.size(), q + qn, 0);
+	if (r) {
+		std::copy(numerator.begin(), numerator.end(), r);
+		std::fill(r + numerator.size(), r + dn, 0);
+	}
+}
+
+void divmod(
+	uint32_t *q, uint32_t *r, const uint32_t *n, size_t nn, const uint32_t *d,
+	size_t dn
+) {
+	assert(dn > 0 && d[dn - 1] != 0);
+	if (nn < dn) {
+		if (r) {
+			std::copy(n, n + nn, r);
+			std::fill(r + nn, r + dn, 0);
+		}
+		return;
+	}
+	if (std::min(nn - dn + 1, dn) >= newtonThreshold)
+		return divNewton(q, r, n, nn, d, dn);
+	divKnuth(q, r, n, nn, d, dn);
+}
+} // namespace LongArithm::kernels
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "../LimbPool.hpp"
+
+// Low level routines working on raw limb arrays
+// Limbs are stored in little endian (the same way `LongNumber::chunks` is)
+// Unless stated otherwise output buffers must not overlap with the inputs
+namespace LongArithm::kernels {
+// Temporaries are drawn from the pool of the current `ArenaScope`
+using Limbs = std::vector<uint32_t, PoolAllocator<uint32_t>>;
+__extension__ typedef unsigned __int128 uint128_t;
+
+// *64 BIT WORDS*
+// Hot loops process pairs of limbs as 64 bit words
+// Intrinsics are used where available with a portable fallback
+
+// Both compile to a single 64 bit load/store on little endian targets
+inline uint64_t load64(const uint32_t *p) {
+	return static_cast<uint64_t>(p[1]) << 32 | p[0];
+}
+inline void store64(uint32_t *p, uint64_t value) {
+	p[0] = static_cast<uint32_t>(value);
+	p[1] = static_cast<uint32_t>(value >> 32);
+}
+
+// sum = a + b + carry, returns carry out
+inline unsigned char
+addCarry(unsigned char carry, uint64_t a, uint64_t b, uint64_t &sum) {
+#if defined(__x86_64__)
+	unsigned long long out;
+	carry = _addcarry_u64(carry, a, b, &out);
+	sum = out;
+	return carry;
+#else
+	uint128_t result = static_cast<uint128_t>(a) + b + carry;
+	sum = static_cast<uint64_t>(result);
+	return static_cast<unsigned char>(result >> 64);
+#endif
+}
+
+// diff = a - b - borrow, returns borrow out
+inline unsigned char
+subBorrow(unsigned char borrow, uint64_t a, uint64_t b, uint64_t &diff) {
+#if defined(__x86_64__)
+	unsigned long long out;
+	borrow = _subborrow_u64(borrow, a, b, &out);
+	diff = out;
+	return borrow;
+#else
+	uint128_t result = static_cast<uint128_t>(a) - b - borrow;
+	diff = static_cast<uint64_t>(result);
+	return static_cast<unsigned char>(result >> 127);
+#endif
+}
+
+// Returns the low half of a * b, the high half is written to `high`
+inline uint64_t mulWide(uint64_t a, uint64_t b, uint64_t &high) {
+#if defined(__BMI2__)
+	unsigned long long out;
+	uint64_t low = _mulx_u64(a, b, &out);
+	high = out;
+	return low;
+#else
+	uint128_t product = static_cast<uint128_t>(a) * b;
+	high = static_cast<uint64_t>(product >> 64);
+	return static_cast<uint64_t>(product);
+#endif
+}
+
+// *BASIC UTILS*
+
+// Returns the size of `a` without leading (most significant) zero limbs
+size_t normalizedSize(const uint32_t *a, size_t n);
+// Returns the number of least significant zero limbs
+size_t lowZeroCount(const uint32_t *a, size_t n);
+// Removes leading zero limbs
+void normalize(Limbs &a);
+// Compares `a` and `b` as unsigned integers, zero limbs on top are ignored
+int compare(const uint32_t *a, size_t an, const uint32_t *b, size_t bn);
+// Compares `a` and `b` (both of size `n`) from the most significant limb
+int compareN(const uint32_t *a, const uint32_t *b, size_t n);
+
+// r = a + b (both of size `n`), returns carry. `r` may alias `a` or `b`
+uint32_t addN(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n);
+// r = a - b (both of size `n`), returns borrow. `r` may alias `a` or `b`
+uint32_t subN(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n);
+// r = a + b, requires an >= bn, `r` has `an` limbs. Returns carry
+uint32_t
+add(uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn);
+// r = a - b, requires an >= bn, `r` has `an` limbs. Returns borrow
+uint32_t
+sub(uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn);
+// r += a, `r` has `rn` >= `an` limbs. Returns carry out of `r[rn - 1]`
+uint32_t addInPlace(uint32_t *r, size_t rn, const uint32_t *a, size_t an);
+// r -= a, `r` has `rn` >= `an` limbs. Returns borrow out of `r[rn - 1]`
+uint32_t subInPlace(uint32_t *r, size_t rn, const uint32_t *a, size_t an);
+// r = 2^(32 * n) - r (two's complement), zero stays zero
+void negate(uint32_t *r, size_t n);
+
+// r[0..n) = a[0..n) * w, returns carry. `r` may alias `a`
+uint32_t mulWord(uint32_t *r, const uint32_t *a, size_t n, uint32_t w);
+// r[0..n) = a[0..n) * w for a 64 bit `w`, returns carry. `r` may alias `a`
+uint64_t mulDoubleWord(uint32_t *r, const uint32_t *a, size_t n, uint64_t w);
+// r[0..n) += a[0..n) * w, returns carry
+uint32_t addMulWord(uint32_t *r, const uint32_t *a, size_t n, uint32_t w);
+// r[0..n) += a[0..n) * w on 64 bit words, returns carry
+uint64_t addMulWord64(uint64_t *r, const uint64_t *a, size_t n, uint64_t w);
+// r[0..n) -= a[0..n) * w, returns borrow
+uint32_t subMulWord(uint32_t *r, const uint32_t *a, size_t n, uint32_t w);
+
+// *SHIFTS*
+
+// r = a << shift (0 <= shift < 32), returns the bits shifted out
+// `r` may alias `a`
+uint32_t shiftLeft(uint32_t *r, const uint32_t *a, size_t n, unsigned shift);
+// r = a >> shift (0 <= shift < 32), returns the bits shifted out
+// placed in the most significant bits. `r` may alias `a`
+uint32_t shiftRight(uint32_t *r, const uint32_t *a, size_t n, unsigned shift);
+
+// *CPU DISPATCH*
+// Kernels above with several implementations call the one from the
+// table of the current `CpuTier`, see `setCpuTier`
+
+struct KernelTable {
+	uint32_t (*addN)(uint32_t *, const uint32_t *, const uint32_t *, size_t);
+	uint32_t (*subN)(uint32_t *, const uint32_t *, const uint32_t *, size_t);
+	uint64_t (*addMulWord64)(uint64_t *, const uint64_t *, size_t, uint64_t);
+	uint32_t (*shiftLeft)(uint32_t *, const uint32_t *, size_t, unsigned);
+	uint32_t (*shiftRight)(uint32_t *, const uint32_t *, size_t, unsigned);
+};
+// Table of the current tier, the detected one until `setCpuTier`
+const KernelTable &kernelTable(void);
+
+// Portable implementations with the contracts of the kernels above
+uint32_t
+addNGeneric(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n);
+uint32_t
+subNGeneric(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n);
+uint64_t
+addMulWord64Generic(uint64_t *r, const uint64_t *a, size_t n, uint64_t w);
+uint32_t
+shiftLeftGeneric(uint32_t *r, const uint32_t *a, size_t n, unsigned shift);
+uint32_t
+shiftRightGeneric(uint32_t *r, const uint32_t *a, size_t n, unsigned shift);
+
+// Compiled for their instruction set with target attributes, may only be
+// called if the CPU supports it
+#if defined(__x86_64__)
+// mulx with two carry chains (adcx and adox)
+uint64_t
+addMulWord64BMI2(uint64_t *r, const uint64_t *a, size_t n, uint64_t w);
+uint32_t
+addNAVX2(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n);
+uint32_t
+subNAVX2(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n);
+uint32_t
+addNAVX512(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n);
+uint32_t
+subNAVX512(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n);
+// Require `n` > 0 and 0 < shift < 32
+uint32_t
+shiftLeftAVX2(uint32_t *r, const uint32_t *a, size_t n, unsigned shift);
+uint32_t
+shiftRightAVX2(uint32_t *r, const uint32_t *a, size_t n, unsigned shift);
+#endif
+
+// *PARALLELISM*
+
+// Starts `task` on a new thread if less than `getThreadCount()` threads
+// are busy, otherwise `task` runs in the calling thread on `get()`
+// The returned future must be waited on before the captured state dies
+std::future<void> spawn(std::function<void()> task);
+
+// *MULTIPLICATION*
+
+// All multiplication routines write `an + bn` limbs to `r`
+// `r` must not overlap with `a` or `b`
+void mulSchoolbook(
+	uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn
+);
+void mulKaratsuba(
+	uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn
+);
+void mulToom3(
+	uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn
+);
+// Exact for operands up to `nttMaxOperandSize` limbs (the smaller one)
+// and transform lengths up to 2^25, see `nttSupported`
+void mulNTT(
+	uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn
+);
+constexpr size_t nttMaxOperandSize = size_t(1) << 23;
+bool nttSupported(size_t an, size_t bn);
+// Picks the algorithm based on operand sizes and `MultiplicationThresholds`
+// Squares if `a` and `b` are the same limbs
+void mul(
+	uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn
+);
+
+// *SQUARING*
+
+// All squaring routines write `2 * n` limbs to `r`
+// `r` must not overlap with `a`
+void sqrSchoolbook(uint32_t *r, const uint32_t *a, size_t n);
+void sqrKaratsuba(uint32_t *r, const uint32_t *a, size_t n);
+void sqrToom3(uint32_t *r, const uint32_t *a, size_t n);
+void sqrNTT(uint32_t *r, const uint32_t *a, size_t n);
+// Uses the same `MultiplicationThresholds` as `mul`
+void sqr(uint32_t *r, const uint32_t *a, size_t n);
+
+// *DIVISION*
+
+// All division routines require the top limb of `d` to be non zero
+// and `nn` >= `dn`. `q` receives `nn - dn + 1` limbs, `r` receives `dn`
+// limbs and may be `nullptr` if the remainder is not needed
+// `q` and `r` must not overlap with the inputs
+
+// Division by a single limb, returns the remainder. `q` may alias `a`
+uint32_t divWord(uint32_t *q, const uint32_t *a, size_t n, uint32_t d);
+// Division by a 64 bit `d`, returns the remainder. `q` may alias `a`
+uint64_t divDoubleWord(uint32_t *q, const uint32_t *a, size_t n, uint64_t d);
+// Knuth's algorithm D, O(nn * dn)
+void divKnuth(
+	uint32_t *q, uint32_t *r, const uint32_t *n, size_t nn, const uint32_t *d,
+	size_t dn
+);
+// Multiplies by a Newton-Raphson reciprocal of `d`, O(M(nn))
+void divNewton(
+	uint32_t *q, uint32_t *r, const uint32_t *n, size_t nn, const uint32_t *d,
+	size_t dn
+);
+// Picks the algorithm based on operand sizes
+// Unlike the other division routines accepts `nn` < `dn`,
+// in which case `q` is left untouched
+void divmod(
+	uint32_t *q, uint32_t *r, const uint32_t *n, size_t nn, const uint32_t *d,
+	size_t dn
+);
+
+// *RADIX CONVERSION*
+
+// Returns 10^exponent
+Limbs powerOfTen(size_t exponent);
+// Receives consecutive blocks of digits, most significant first
+using DigitSink = std::function<void(std::string_view digits)>;
+// Hands exactly `digits` decimal digits of `a`, zero padded on the left,
+// to `sink` in blocks of at most `blockDigits`. Requires `a` < 10^digits
+// Only a single block is held in memory
+void toDecimal(
+	const uint32_t *a, size_t n, size_t digits, size_t blockDigits,
+	const DigitSink &sink
+);
+// Parses `n` decimal digits (characters '0' to '9' only)
+Limbs fromDecimal(const char *digits, size_t n);
+} // namespace LongArithm::kernels
@@ -0,0 +1,387 @@
+#include <algorithm>
+#include <cassert>
+
+#include "../LongArithm.hpp"
+#include "../SmallVector.hpp"
+#include "../Stats.hpp"
+#include "kernels.hpp"
+
+namespace LongArithm {
+
+// *TUNABLES*
+
+namespace {
+MultiplicationThresholds thresholds;
+}
+
+// Karatsuba on less than 4 chunks would recurse on operands of the same size
+void setMultiplicationThresholds(const MultiplicationThresholds &values) {
+	thresholds = values;
+	thresholds.karatsuba = std::max<size_t>(thresholds.karatsuba, 4);
+	thresholds.toom3 = std::max<size_t>(thresholds.toom3, 4);
+	thresholds.ntt = std::max<size_t>(thresholds.ntt, 1);
+}
+
+MultiplicationThresholds getMultiplicationThresholds(void) {
+	return thresholds;
+}
+
+namespace kernels {
+
+// *SIGNED HELPERS*
+// Toom-3 interpolation goes through negative intermediate values
+
+namespace {
+// Toom-3 pieces of at least this many limbs are multiplied in parallel
+// Smaller ones do not pay for starting a thread
+constexpr size_t parallelThreshold = 256;
+
+struct Signed {
+	Limbs mag;
+	bool neg = false;
+};
+
+Signed fromLimbs(const uint32_t *a, size_t n) {
+	Signed result;
+	result.mag.assign(a, a + normalizedSize(a, n));
+	return result;
+}
+
+// Returns a + b or a - b depending on `subtract`
+Signed addSigned(const Signed &a, const Signed &b, bool subtract = false) {
+	bool bNeg = b.neg != subtract;
+	Signed result;
+	const Limbs &x = a.mag.size() >= b.mag.size() ? a.mag : b.mag;
+	const Limbs &y = a.mag.size() >= b.mag.size() ? b.mag : a.mag;
+	if (a.neg == bNeg) {
+		result.mag.resize(x.size() + 1);
+		result.mag.back() =
+			add(result.mag.data(), x.data(), x.size(), y.data(), y.size());
+		result.neg = a.neg;
+	} else {
+		int cmp =
+			compare(a.mag.data(), a.mag.size(), b.mag.data(), b.mag.size());
+		const Limbs &larger = cmp >= 0 ? a.mag : b.mag;
+		const Limbs &smaller = cmp >= 0 ? b.mag : a.mag;
+		result.mag.resize(larger.size());
+		sub(
+			result.mag.data(), larger.data(), larger.size(), smaller.data(),
+			smaller.size()
+		);
+		result.neg = cmp >= 0 ? a.neg : bNeg;
+	}
+	normalize(result.mag);
+	if (result.mag.empty()) result.neg = false;
+	return result;
+}
+
+Signed mulSigned(const Signed &a, const Signed &b) {
+	Signed result;
+	result.mag.resize(a.mag.size() + b.mag.size());
+	mul(
+		result.mag.data(), a.mag.data(), a.mag.size(), b.mag.data(),
+		b.mag.size()
+	);
+	normalize(result.mag);
+	result.neg = !result.mag.empty() && a.neg != b.neg;
+	return result;
+}
+
+// Division where the remainder is known to be zero
+void divExact(Signed &a, uint32_t divisor) {
+	uint64_t remainder = 0;
+	for (size_t i = a.mag.size(); i-- > 0;) {
+		uint64_t cur = (remainder << 32) | a.mag[i];
+		a.mag[i] = static_cast<uint32_t>(cur / divisor);
+		remainder = cur % divisor;
+	}
+	assert(remainder == 0);
+	normalize(a.mag);
+}
+
+void shiftLeftOne(Signed &a) {
+	uint32_t carry = 0;
+	for (uint32_t &limb : a.mag) {
+		uint32_t newCarry = limb >> 31;
+		limb = (limb << 1) | carry;
+		carry = newCarry;
+	}
+	if (carry) a.mag.push_back(carry);
+}
+
+// Adds `a` (non-negative) to `r` shifted by `offset` limbs
+void accumulate(uint32_t *r, size_t rn, size_t offset, const Signed &a) {
+	assert(!a.neg && offset + a.mag.size() <= rn);
+	uint32_t carry =
+		addInPlace(r + offset, rn - offset, a.mag.data(), a.mag.size());
+	assert(carry == 0);
+	(void)carry;
+}
+
+Signed sqrSigned(const Signed &a) {
+	Signed result;
+	result.mag.resize(2 * a.mag.size());
+	sqr(result.mag.data(), a.mag.data(), a.mag.size());
+	normalize(result.mag);
+	return result;
+}
+
+// Values of a number split in 3 pieces of `k` limbs, evaluated
+// as a polynomial at 0, 1, -1, -2 and inf
+struct Toom3Points {
+	Signed at0, at1, atM1, atM2, atInf;
+};
+
+Toom3Points toom3Evaluate(const uint32_t *a, size_t an, size_t k) {
+	Toom3Points v;
+	v.at0 = fromLimbs(a, k);
+	Signed a1 = fromLimbs(a + k, k);
+	v.atInf = fromLimbs(a + 2 * k, an - 2 * k);
+
+	Signed p = addSigned(v.at0, v.atInf);
+	v.at1 = addSigned(p, a1);
+	v.atM1 = addSigned(p, a1, true);
+	v.atM2 = addSigned(v.atM1, v.atInf);
+	shiftLeftOne(v.atM2);
+	v.atM2 = addSigned(v.atM2, v.at0, true);
+	return v;
+}
+
+// Recovers `rn` limbs of the product from its values at the Toom-3 points
+// Interpolation sequence by Marco Bodrato
+void toom3Interpolate(uint32_t *r, size_t rn, size_t k, Toom3Points &v) {
+	Signed &r0 = v.at0, &r1 = v.at1, &rM1 = v.atM1, &rM2 = v.atM2,
+		   &rInf = v.atInf;
+	Signed r3 = addSigned(rM2, r1, true);
+	divExact(r3, 3);
+	r1 = addSigned(r1, rM1, true);
+	divExact(r1, 2);
+	Signed r2 = addSigned(rM1, r0, true);
+	r3 = addSigned(r2, r3, true);
+	divExact(r3, 2);
+	r3 = addSigned(r3, rInf);
+	r3 = addSigned(r3, rInf);
+	r2 = addSigned(r2, r1);
+	r2 = addSigned(r2, rInf, true);
+	r1 = addSigned(r1, r3, true);
+
+	// Recomposition
+	std::fill(r, r + rn, 0);
+	accumulate(r, rn, 0, r0);
+	accumulate(r, rn, k, r1);
+	accumulate(r, rn, 2 * k, r2);
+	accumulate(r, rn, 3 * k, r3);
+	accumulate(r, rn, 4 * k, rInf);
+}
+
+// Multiplies by splitting `a` into `bn` sized pieces
+// Used when operands are too unbalanced for Karatsuba and Toom-3
+void mulUnbalanced(
+	uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn
+) {
+	std::fill(r, r + an + bn, 0);
+	if (bn == 0) return;
+	Limbs product(2 * bn);
+	for (size_t i = 0; i < an; i += bn) {
+		size_t len = std::min(bn, an - i);
+		mul(product.data(), a + i, len, b, bn);
+		addInPlace(r + i, an + bn - i, product.data(), len + bn);
+	}
+}
+} // namespace
+
+// *MULTIPLICATION*
+
+// O(n * m) multiplication
+// Operands are packed into 64 bit words, odd sizes get a zero top half
+void mulSchoolbook(
+	uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn
+) {
+	STATS_TIME(MulSchoolbook, an + bn);
+	size_t aw = (an + 1) / 2, bw = (bn + 1) / 2;
+	SmallVector<uint64_t, 32> x(aw), y(bw), z(aw + bw);
+	for (size_t i = 0; i < an; i++)
+		x[i / 2] |= static_cast<uint64_t>(a[i]) << (i % 2 * 32);
+	for (size_t i = 0; i < bn; i++)
+		y[i / 2] |= static_cast<uint64_t>(b[i]) << (i % 2 * 32);
+
+	for (size_t j = 0; j < bw; j++)
+		z[j + aw] = addMulWord64(z.data() + j, x.data(), aw, y[j]);
+	for (size_t i = 0; i < an + bn; i++)
+		r[i] = static_cast<uint32_t>(z[i / 2] >> (i % 2 * 32));
+}
+
+// Splits operands in halves and uses 3 half sized multiplications
+// (a1 * B + a0) * (b1 * B + b0) = z2 * B^2 + z1 * B + z0
+// z1 = (a0 + a1) * (b0 + b1) - z2 - z0
+void mulKaratsuba(
+	uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn
+) {
+	STATS_TIME(MulKaratsuba, an + bn);
+	if (an < bn) {
+		std::swap(a, b);
+		std::swap(an, bn);
+	}
+	size_t m = (an + 1) / 2;
+	if (bn <= m) return mulUnbalanced(r, a, an, b, bn);
+
+	size_t a1n = an - m, b1n = bn - m;
+	size_t rn = an + bn;
+	mul(r, a, m, b, m);						// z0
+	mul(r + 2 * m, a + m, a1n, b + m, b1n); // z2
+
+	Limbs sumA(m + 1), sumB(m + 1);
+	sumA[m] = add(sumA.data(), a, m, a + m, a1n);
+	sumB[m] = add(sumB.data(), b, m, b + m, b1n);
+	size_t sumAn = normalizedSize(sumA.data(), m + 1);
+	size_t sumBn = normalizedSize(sumB.data(), m + 1);
+
+	Limbs z1(2 * m + 2, 0);
+	mul(z1.data(), sumA.data(), sumAn, sumB.data(), sumBn);
+	subInPlace(z1.data(), z1.size(), r, 2 * m);
+	subInPlace(z1.data(), z1.size(), r + 2 * m, rn - 2 * m);
+	addInPlace(r + m, rn - m, z1.data(), normalizedSize(z1.data(), z1.size()));
+}
+
+// Splits operands in thirds, evaluates them at 0, 1, -1, -2, inf
+// and interpolates the result using 5 third sized multiplications
+void mulToom3(
+	uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn
+) {
+	STATS_TIME(MulToom3, an + bn);
+	if (an < bn) {
+		std::swap(a, b);
+		std::swap(an, bn);
+	}
+	size_t k = (an + 2) / 3;
+	if (bn <= 2 * k) return mulKaratsuba(r, a, an, b, bn);
+
+	Toom3Points pa = toom3Evaluate(a, an, k), pb = toom3Evaluate(b, bn, k);
+
+	// Pointwise multiplication
+	// Products are independent, large ones are worth running in parallel
+	Toom3Points v;
+	std::vector<std::future<void>> tasks;
+	auto run = [&](Signed &out, const Signed &x, const Signed &y) {
+		auto task = [&out, &x, &y]() { out = mulSigned(x, y); };
+		if (k >= parallelThreshold)
+			tasks.push_back(spawn(task));
+		else
+			task();
+	};
+	run(v.at0, pa.at0, pb.at0);
+	run(v.at1, pa.at1, pb.at1);
+	run(v.atM1, pa.atM1, pb.atM1);
+	run(v.atM2, pa.atM2, pb.atM2);
+	run(v.atInf, pa.atInf, pb.atInf);
+	for (std::future<void> &task : tasks) task.get();
+
+	toom3Interpolate(r, an + bn, k, v);
+}
+
+void mul(
+	uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn
+) {
+	if (an < bn) {
+		std::swap(a, b);
+		std::swap(an, bn);
+	}
+	if (bn == 0) {
+		std::fill(r, r + an, 0);
+		return;
+	}
+	if (a == b && an == bn) return sqr(r, a, an);
+	if (bn < thresholds.karatsuba) return mulSchoolbook(r, a, an, b, bn);
+	// Balanced algorithms lose their advantage on lopsided operands
+	if (an >= 2 * bn) return mulUnbalanced(r, a, an, b, bn);
+	if (bn < thresholds.toom3) return mulKaratsuba(r, a, an, b, bn);
+	// Too large operands for NTT are split by Toom-3 until they fit
+	if (bn >= thresholds.ntt && nttSupported(an, bn))
+		return mulNTT(r, a, an, b, bn);
+	return mulToom3(r, a, an, b, bn);
+}
+
+// *SQUARING*
+// Products a_i * a_j and a_j * a_i are equal, so only one is computed
+
+// Sums a_i * a_j for i < j, doubles it and adds the squares a_i^2
+void sqrSchoolbook(uint32_t *r, const uint32_t *a, size_t n) {
+	STATS_TIME(SqrSchoolbook, n);
+	size_t w = (n + 1) / 2;
+	SmallVector<uint64_t, 32> x(w), z(2 * w);
+	for (size_t i = 0; i < n; i++)
+		x[i / 2] |= static_cast<uint64_t>(a[i]) << (i % 2 * 32);
+
+	for (size_t i = 0; i + 1 < w; i++) {
+		z[i + w] = addMulWord64(
+			z.data() + 2 * i + 1, x.data() + i + 1, w - i - 1, x[i]
+		);
+	}
+	unsigned char carry = 0;
+	uint64_t shifted = 0; // Top bit of the previous word
+	for (size_t i = 0; i < w; i++) {
+		uint64_t high, low = mulWide(x[i], x[i], high);
+		uint64_t z0 = z[2 * i] << 1 | shifted;
+		uint64_t z1 = z[2 * i + 1] << 1 | z[2 * i] >> 63;
+		shifted = z[2 * i + 1] >> 63;
+		carry = addCarry(carry, z0, low, z[2 * i]);
+		carry = addCarry(carry, z1, high, z[2 * i + 1]);
+	}
+	for (size_t i = 0; i < 2 * n; i++)
+		r[i] = static_cast<uint32_t>(z[i / 2] >> (i % 2 * 32));
+}
+
+// a^2 = a1^2 * B^2 + ((a0 + a1)^2 - a1^2 - a0^2) * B + a0^2
+void sqrKaratsuba(uint32_t *r, const uint32_t *a, size_t n) {
+	STATS_TIME(SqrKaratsuba, n);
+	size_t m = (n + 1) / 2;
+	sqr(r, a, m);				  // z0
+	sqr(r + 2 * m, a + m, n - m); // z2
+
+	Limbs sum(m + 1);
+	sum[m] = add(sum.data(), a, m, a + m, n - m);
+	size_t sumn = normalizedSize(sum.data(), m + 1);
+
+	Limbs z1(2 * m + 2, 0);
+	sqr(z1.data(), sum.data(), sumn);
+	subInPlace(z1.data(), z1.size(), r, 2 * m);
+	subInPlace(z1.data(), z1.size(), r + 2 * m, 2 * (n - m));
+	addInPlace(
+		r + m, 2 * n - m, z1.data(), normalizedSize(z1.data(), z1.size())
+	);
+}
+
+// Evaluates `a` once and squares the values at every point
+void sqrToom3(uint32_t *r, const uint32_t *a, size_t n) {
+	STATS_TIME(SqrToom3, n);
+	size_t k = (n + 2) / 3;
+	if (n <= 2 * k) return sqrKaratsuba(r, a, n);
+
+	Toom3Points pa = toom3Evaluate(a, n, k);
+	Toom3Points v;
+	std::vector<std::future<void>> tasks;
+	auto run = [&](Signed &out, const Signed &x) {
+		auto task = [&out, &x]() { out = sqrSigned(x); };
+		if (k >= parallelThreshold)
+			tasks.push_back(spawn(task));
+		else
+			task();
+	};
+	run(v.at0, pa.at0);
+	run(v.at1, pa.at1);
+	run(v.atM1, pa.atM1);
+	run(v.atM2, pa.atM2);
+	run(v.atInf, pa.atInf);
+	for (std::future<void> &task : tasks) task.get();
+
+	toom3Interpolate(r, 2 * n, k, v);
+}
+
+void sqr(uint32_t *r, const uint32_t *a, size_t n) {
+	if (n < thresholds.karatsuba) return sqrSchoolbook(r, a, n);
+	if (n < thresholds.toom3) return sqrKaratsuba(r, a, n);
+	if (n >= thresholds.ntt && nttSupported(n, n)) return sqrNTT(r, a, n);
+	return sqrToom3(r, a, n);
+}
+} // namespace kernels
+} // namespace LongArithm
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+
+#include "../Stats.hpp"
+#include "kernels.hpp"
+
+// Multiplication using number theoretic transform (FFT over Z/pZ)
+// Convolution is computed modulo 3 primes and recombined using CRT
+// Every coefficient of the convolution is below `nttMaxOperandSize` * 2^64
+// which is less than the product of the primes, so the result is exact
+namespace LongArithm::kernels {
+
+namespace {
+// p = k * 2^s + 1 allows transforms of length up to 2^s
+struct Prime {
+	uint32_t p;
+	uint32_t generator;
+	uint32_t maxLog;
+};
+constexpr std::array<Prime, 3> primes = {{
+	{2013265921, 31, 27}, // 15 * 2^27 + 1
+	{469762049, 3, 26},	  // 7 * 2^26 + 1
+	{167772161, 3, 25},	  // 5 * 2^25 + 1
+}};
+
+uint32_t powMod(uint64_t base, uint64_t exponent, uint32_t mod) {
+	uint64_t result = 1;
+	base %= mod;
+	while (exponent) {
+		if (exponent & 1) result = result * base % mod;
+		base = base * base % mod;
+		exponent >>= 1;
+	}
+	return static_cast<uint32_t>(result);
+}
+
+// Montgomery arithmetic with R = 2^32
+// Avoids 64 bit divisions in the butterflies
+class Montgomery {
+  private:
+	uint32_t mod;
+	uint32_t modInv; // -mod^(-1) mod 2^32
+	uint32_t r2;	 // 2^64 mod mod
+
+  public:
+	explicit Montgomery(uint32_t mod) : mod(mod) {
+		uint32_t inv = mod; // Newton iteration for the inverse mod 2^32
+		for (int i = 0; i < 4; i++) inv *= 2 - mod * inv;
+		modInv = -inv;
+		r2 = static_cast<uint32_t>((static_cast<uint128_t>(1) << 64) % mod);
+	}
+
+	// Returns x * 2^(-32) mod p for x < p * 2^32
+	uint32_t reduce(uint64_t x) const {
+		uint32_t m = static_cast<uint32_t>(x) * modInv;
+		uint32_t t = (x + static_cast<uint64_t>(m) * mod) >> 32;
+		return t >= mod ? t - mod : t;
+	}
+	uint32_t mul(uint32_t a, uint32_t b) const {
+		return reduce(static_cast<uint64_t>(a) * b);
+	}
+	uint32_t toMontgomery(uint32_t a) const { return mul(a, r2); }
+	uint32_t add(uint32_t a, uint32_t b) const {
+		uint32_t sum = a + b;
+		return sum >= mod ? sum - mod : sum;
+	}
+	uint32_t sub(uint32_t a, uint32_t b) const {
+		return a >= b ? a - b : a + mod - b;
+	}
+};
+
+// roots[len + j] = w^j where w is a primitive (2 * len)-th root of unity
+// Values are stored in Montgomery form
+Limbs rootsTable(
+	const Montgomery &mont, const Prime &prime, size_t n, bool inverse
+) {
+	Limbs roots(std::max<size_t>(n, 2));
+	for (size_t len = 1; len < n; len <<= 1) {
+		uint32_t w =
+			powMod(prime.generator, (prime.p - 1) / (2 * len), prime.p);
+		if (inverse) w = powMod(w, prime.p - 2, prime.p);
+		uint32_t wMont = mont.toMontgomery(w);
+		roots[len] = mont.toMontgomery(1);
+		for (size_t j = 1; j < len; j++)
+			roots[len + j] = mont.mul(roots[len + j - 1], wMont);
+	}
+	return roots;
+}
+
+// Decimation in frequency, output is in bit reversed order
+void forwardTransform(
+	uint32_t *a, size_t n, const Montgomery &mont, const Limbs &roots
+) {
+	for (size_t len = n / 2; len >= 1; len >>= 1) {
+		for (size_t i = 0; i < n; i += 2 * len) {
+			for (size_t j = 0; j < len; j++) {
+				uint32_t u = a[i + j], v = a[i + j + len];
+				a[i + j] = mont.add(u, v);
+				a[i + j + len] = mont.mul(mont.sub(u, v), roots[len + j]);
+			}
+		}
+	}
+}
+
+// Decimation in time, takes bit reversed input
+void inverseTransform(
+	uint32_t *a, size_t n, const Montgomery &mont, const Limbs &roots
+) {
+	for (size_t len = 1; len < n; len <<= 1) {
+		for (size_t i = 0; i < n; i += 2 * len) {
+			for (size_t j = 0; j < len; j++) {
+				uint32_t u = a[i + j];
+				uint32_t v = mont.mul(a[i + j + len], roots[len + j]);
+				a[i + j] = mont.add(u, v);
+				a[i + j + len] = mont.sub(u, v);
+			}
+		}
+	}
+}
+
+// Writes (a * b) mod p into `out` (n values)
+// Squaring (`a` == `b`) needs only one forward transform
+void convolveModPrime(
+	const Prime &prime, const uint32_t *a, size_t an, const uint32_t *b,
+	size_t bn, size_t n, uint32_t *out
+) {
+	Montgomery mont(prime.p);
+	for (size_t i = 0; i < an; i++) out[i] = a[i] % prime.p;
+	std::fill(out + an, out + n, 0);
+
+	Limbs roots = rootsTable(mont, prime, n, false);
+	forwardTransform(out, n, mont, roots);
+	if (a == b && an == bn) {
+		for (size_t i = 0; i < n; i++) out[i] = mont.mul(out[i], out[i]);
+	} else {
+		Limbs fb(n, 0);
+		for (size_t i = 0; i < bn; i++) fb[i] = b[i] % prime.p;
+		forwardTransform(fb.data(), n, mont, roots);
+		for (size_t i = 0; i < n; i++) out[i] = mont.mul(out[i], fb[i]);
+	}
+
+	roots = rootsTable(mont, prime, n, true);
+	inverseTransform(out, n, mont, roots);
+	// Pointwise products picked up a factor of 2^(-32)
+	// Multiplying by n^(-1) * 2^64 in Montgomery form cancels it out
+	uint32_t scale = powMod(n, prime.p - 2, prime.p);
+	scale = mont.toMontgomery(mont.toMontgomery(scale));
+	for (size_t i = 0; i < n; i++) out[i] = mont.mul(out[i], scale);
+}
+} // namespace
+
+bool nttSupported(size_t an, size_t bn) {
+	size_t n = std::bit_ceil(an + bn);
+	return std::min(an, bn) <= nttMaxOperandSize &&
+		   n <= (size_t(1) << primes.back().maxLog);
+}
+
+void mulNTT(
+	uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn
+) {
+	STATS_TIME(MulNTT, an + bn);
+	assert(nttSupported(an, bn));
+	size_t rn = an + bn;
+	size_t n = std::bit_ceil(rn);
+	std::array<Limbs, 3> residues;
+	// Convolutions modulo different primes are independent
+	std::array<std::future<void>, 3> tasks;
+	for (size_t i = 0; i < primes.size(); i++) {
+		residues[i].resize(n);
+		tasks[i] = spawn([&, i]() {
+			convolveModPrime(primes[i], a, an, b, bn, n, residues[i].data());
+		});
+	}
+	for (std::future<void> &task : tasks) task.get();
+
+	// Garner's algorithm
+	const uint64_t p1 = primes[0].p, p2 = primes[1].p, p3 = primes[2].p;
+	// p1^(-1) mod p2 and (p1 * p2)^(-1) mod p3
+	const uint64_t p1Inv = powMod(p1, p2 - 2, p2);
+	const uint64_t p12Inv = powMod(p1 * p2 % p3, p3 - 2, p3);
+	uint128_t carry = 0;
+	for (size_t i = 0; i < rn; i++) {
+		uint64_t x1 = residues[0][i], x2 = residues[1][i], x3 = residues[2][i];
+		uint64_t t2 = (x2 + p2 - x1 % p2) % p2 * p1Inv % p2;
+		uint64_t x12 = x1 + p1 * t2;
+		uint64_t t3 = (x3 + p3 - x12 % p3) % p3 * p12Inv % p3;
+		carry += x12 + static_cast<uint128_t>(p1 * p2) * t3;
+		r[i] = static_cast<uint32_t>(carry);
+		carry >>= 32;
+	}
+	assert(carry == 0);
+}
+
+void sqrNTT(uint32_t *r, const uint32_t *a, size_t n) {
+	STATS_TIME(SqrNTT, n);
+	mulNTT(r, a, n, a, n);
+}
+} // namespace LongArithm::kernels
@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <atomic>
+#include <optional>
+
+#include "../LongArithm.hpp"
+#include "kernels.hpp"
+
+namespace LongArithm {
+
+// *TUNABLES*
+
+namespace {
+std::atomic<unsigned> threadCount = 1;
+// Threads started by `spawn` that have not finished yet
+std::atomic<unsigned> busyThreads = 0;
+} // namespace
+
+void setThreadCount(unsigned threads) {
+	threadCount = std::max(threads, 1U);
+}
+
+unsigned getThreadCount(void) { return threadCount; }
+
+namespace kernels {
+
+// *PARALLELISM*
+
+std::future<void> spawn(std::function<void()> task) {
+	unsigned busy = busyThreads.load();
+	// The calling thread counts towards the budget as well
+	while (busy + 1 < threadCount) {
+		if (!busyThreads.compare_exchange_weak(busy, busy + 1)) continue;
+		bool pooled = ArenaScope::isActive();
+		auto run = [task = std::move(task), pooled]() {
+			// Release the slot even if `task` throws
+			struct Release {
+				~Release() { busyThreads--; }
+			} release;
+			// Pools are per thread, the worker gets its own
+			std::optional<ArenaScope> scope;
+			if (pooled) scope.emplace();
+			task();
+		};
+		return std::async(std::launch::async, std::move(run));
+	}
+	return std::async(std::launch::deferred, std::move(task));
+}
+} // namespace kernels
+} // namespace LongArithm
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "../Stats.hpp"
+#include "kernels.hpp"
+
+// Conversion between limbs and decimal digits
+// Small numbers are split into (or built from) 9 digit words
+// by repeated division (multiplication) by 10^9
+// Large ones are split in halves by a power of 10 from a precomputed tree
+namespace LongArithm::kernels {
+
+namespace {
+constexpr uint32_t wordBase = 1000000000; // 10^9
+constexpr size_t digitsPerWord = 9;
+// Below this many limbs dividing by 10^9 is faster than splitting
+constexpr size_t radixThreshold = 48;
+// Same for parsing, ~48 limbs worth of digits
+constexpr size_t parseThreshold = 432;
+// Halves of at least this many limbs are converted in parallel
+constexpr size_t parallelThreshold = 4096;
+
+// powers[i] = 10^(9 * 2^i)
+using PowerTree = std::vector<Limbs>;
+
+PowerTree powerTree(size_t digits) {
+	PowerTree powers = {{wordBase}};
+	while (digitsPerWord << powers.size() < digits) {
+		const Limbs &last = powers.back();
+		Limbs square(2 * last.size());
+		mul(square.data(), last.data(), last.size(), last.data(),
+			last.size());
+		normalize(square);
+		powers.push_back(std::move(square));
+	}
+	return powers;
+}
+
+// Level of the largest power in the tree with less than `digits` digits
+size_t splitLevel(const PowerTree &powers, size_t digits) {
+	size_t level = 0;
+	while (level + 1 < powers.size() &&
+		   digitsPerWord << (level + 1) < digits)
+		level++;
+	return level;
+}
+
+// Writes exactly `digits` digits of `a` < 10^digits to `out`
+// `a` is used as a scratch buffer
+void convertWords(Limbs &a, char *out, size_t digits) {
+	size_t n = normalizedSize(a.data(), a.size());
+	char *cur = out + digits;
+	while (cur != out) {
+		uint32_t word = n == 0 ? 0 : divWord(a.data(), a.data(), n, wordBase);
+		n = normalizedSize(a.data(), n);
+		for (size_t i = 0; i < digitsPerWord && cur != out; i++) {
+			*--cur = '0' + word % 10;
+			word /= 10;
+		}
+	}
+}
+
+void convert(Limbs a, char *out, size_t digits, const PowerTree &powers) {
+	normalize(a);
+	if (a.size() < radixThreshold) return convertWords(a, out, digits);
+
+	// `hi` has at most as many digits as `lo`
+	size_t level = splitLevel(powers, digits);
+	size_t loDigits = digitsPerWord << level;
+	const Limbs &divisor = powers[level];
+
+	Limbs hi, lo(divisor.size(), 0);
+	if (a.size() >= divisor.size()) {
+		hi.resize(a.size() - divisor.size() + 1);
+		divmod(
+			hi.data(), lo.data(), a.data(), a.size(), divisor.data(),
+			divisor.size()
+		);
+	} else {
+		std::copy(a.begin(), a.end(), lo.begin());
+	}
+
+	std::future<void> hiTask;
+	auto convertHi = [&]() {
+		convert(std::move(hi), out, digits - loDigits, powers);
+	};
+	if (a.size() >= parallelThreshold)
+		hiTask = spawn(convertHi);
+	else
+		convertHi();
+	convert(std::move(lo), out + digits - loDigits, loDigits, powers);
+	if (hiTask.valid()) hiTask.get();
+}
+
+// `convert` that emits blocks of at most `blockDigits` through `sink`
+// Halves above the block size are converted one after another so that
+// digits come out in order, every block is converted by `convert`
+void convertBlocks(
+	Limbs a, size_t digits, const PowerTree &powers, size_t blockDigits,
+	std::string &block, const DigitSink &sink
+) {
+	// Single words are not split, blocks of less than 9 digits are sliced
+	if (digits <= std::max(blockDigits, digitsPerWord)) {
+		block.resize(digits);
+		convert(std::move(a), block.data(), digits, powers);
+		std::string_view digitsView = block;
+		for (size_t i = 0; i < digits; i += blockDigits)
+			sink(digitsView.substr(i, blockDigits));
+		return;
+	}
+	normalize(a);
+	size_t level = splitLevel(powers, digits);
+	size_t loDigits = digitsPerWord << level;
+	const Limbs &divisor = powers[level];
+
+	Limbs hi, lo(divisor.size(), 0);
+	if (a.size() >= divisor.size()) {
+		hi.resize(a.size() - divisor.size() + 1);
+		divmod(
+			hi.data(), lo.data(), a.data(), a.size(), divisor.data(),
+			divisor.size()
+		);
+	} else {
+		std::copy(a.begin(), a.end(), lo.begin());
+	}
+	// `a` is not needed past this point
+	a = Limbs();
+	convertBlocks(
+		std::move(hi), digits - loDigits, powers, blockDigits, block, sink
+	);
+	convertBlocks(std::move(lo), loDigits, powers, blockDigits, block, sink);
+}
+
+Limbs parseWords(const char *digits, size_t n) {
+	Limbs result;
+	for (size_t i = 0; i < n;) {
+		// The first word takes the remainder so that the rest are full
+		size_t len = i == 0 && n % digitsPerWord ? n % digitsPerWord
+												 : digitsPerWord;
+		uint32_t word = 0, scale = 1;
+		for (size_t j = 0; j < len; j++, i++) {
+			word = word * 10 + (digits[i] - '0');
+			scale *= 10;
+		}
+		result.push_back(0);
+		uint32_t carry =
+			mulWord(result.data(), result.data(), result.size(), scale);
+		assert(carry == 0);
+		(void)carry;
+		addInPlace(result.data(), result.size(), &word, 1);
+		normalize(result);
+	}
+	return result;
+}
+
+Limbs parse(const char *digits, size_t n, const PowerTree &powers) {
+	if (n < parseThreshold) return parseWords(digits, n);
+
+	size_t level = splitLevel(powers, n);
+	size_t loDigits = digitsPerWord << level;
+	const Limbs &scale = powers[level];
+
+	Limbs hi;
+	std::future<void> hiTask;
+	auto parseHi = [&]() { hi = parse(digits, n - loDigits, powers); };
+	if (n >= parallelThreshold * digitsPerWord)
+		hiTask = spawn(parseHi);
+	else
+		parseHi();
+	Limbs lo = parse(digits + n - loDigits, loDigits, powers);
+	if (hiTask.valid()) hiTask.get();
+
+	// hi * 10^loDigits + lo
+	Limbs result(hi.size() + scale.size() + 1, 0);
+	mul(result.data(), hi.data(), hi.size(), scale.data(), scale.size());
+	addInPlace(result.data(), result.size(), lo.data(), lo.size());
+	normalize(result);
+	return result;
+}
+} // namespace
+
+Limbs powerOfTen(size_t exponent) {
+	Limbs result = {1}, base = {10};
+	while (exponent) {
+		if (exponent & 1) {
+			Limbs product(result.size() + base.size());
+			mul(product.data(), result.data(), result.size(), base.data(),
+				base.size());
+			normalize(product);
+			result = std::move(product);
+		}
+		exponent >>= 1;
+		if (!exponent) break;
+		Limbs square(2 * base.size());
+		mul(square.data(), base.data(), base.size(), base.data(),
+			base.size());
+		normalize(square);
+		base = std::move(square);
+	}
+	return result;
+}
+
+void toDecimal(
+	const uint32_t *a, size_t n, size_t digits, size_t blockDigits,
+	const DigitSink &sink
+) {
+	STATS_TIME(ToDecimal, n);
+	if (digits == 0) return;
+	blockDigits = std::max<size_t>(blockDigits, 1);
+	std::string block;
+	block.reserve(std::min(digits, blockDigits));
+	convertBlocks(
+		Limbs(a, a + n), digits, powerTree(digits), blockDigits, block, sink
+	);
+}
+
+Limbs fromDecimal(const char *digits, size_t n) {
+	STATS_TIME(FromDecimal, n / 9 + 1);
+	// Leading zeros only slow the conversion down
+	while (n > 0 && *digits == '0') {
+		digits++;
+		n--;
+	}
+	if (n < parseThreshold) return parseWords(digits, n);
+	return parse(digits, n, powerTree(n));
+}
+} // namespace LongArithm::kernels
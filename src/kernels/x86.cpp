@@ -0,0 +1,270 @@
+#include "kernels.hpp"
+
+// Kernels for instruction set extensions, compiled with target attributes
+// so that the rest of the build stays portable. See `kernelTable`
+namespace LongArithm::kernels {
+#if defined(__x86_64__)
+
+// *MULTIPLY-ADD*
+
+// r[i] + low(a[i] * w) + high(a[i - 1] * w) are summed on two independent
+// carry chains: adcx only touches CF and adox only OF. Compilers do not
+// interleave the chains from intrinsics, hence the assembly. The loops
+// are counted in rcx with lea and jrcxz which leave both flags intact
+__attribute__((target("bmi2,adx"))) uint64_t
+addMulWord64BMI2(uint64_t *r, const uint64_t *a, size_t n, uint64_t w) {
+	uint64_t carry, low, high, limb;
+	size_t single = n % 4, blocks = n / 4;
+	__asm__(
+		// Clears CF and OF as well
+		"xorl %k[carry], %k[carry]\n\t"
+		"1:\n\t"
+		"jrcxz 2f\n\t"
+		"mulxq (%[a]), %[low], %[high]\n\t"
+		"movq (%[r]), %[limb]\n\t"
+		"adcxq %[low], %[limb]\n\t"
+		"adoxq %[carry], %[limb]\n\t"
+		"movq %[limb], (%[r])\n\t"
+		"movq %[high], %[carry]\n\t"
+		"leaq 8(%[a]), %[a]\n\t"
+		"leaq 8(%[r]), %[r]\n\t"
+		"leaq -1(%%rcx), %%rcx\n\t"
+		"jmp 1b\n\t"
+		"2:\n\t"
+		"movq %[blocks], %%rcx\n\t"
+		// jrcxz only jumps 127 bytes, the exit goes through a trampoline
+		"3:\n\t"
+		"jrcxz 4f\n\t"
+		"jmp 5f\n\t"
+		"4:\n\t"
+		"jmp 6f\n\t"
+		"5:\n\t"
+		"mulxq (%[a]), %[low], %[high]\n\t"
+		"movq (%[r]), %[limb]\n\t"
+		"adcxq %[low], %[limb]\n\t"
+		"adoxq %[carry], %[limb]\n\t"
+		"movq %[limb], (%[r])\n\t"
+		"movq %[high], %[carry]\n\t"
+		"mulxq 8(%[a]), %[low], %[high]\n\t"
+		"movq 8(%[r]), %[limb]\n\t"
+		"adcxq %[low], %[limb]\n\t"
+		"adoxq %[carry], %[limb]\n\t"
+		"movq %[limb], 8(%[r])\n\t"
+		"movq %[high], %[carry]\n\t"
+		"mulxq 16(%[a]), %[low], %[high]\n\t"
+		"movq 16(%[r]), %[limb]\n\t"
+		"adcxq %[low], %[limb]\n\t"
+		"adoxq %[carry], %[limb]\n\t"
+		"movq %[limb], 16(%[r])\n\t"
+		"movq %[high], %[carry]\n\t"
+		"mulxq 24(%[a]), %[low], %[high]\n\t"
+		"movq 24(%[r]), %[limb]\n\t"
+		"adcxq %[low], %[limb]\n\t"
+		"adoxq %[carry], %[limb]\n\t"
+		"movq %[limb], 24(%[r])\n\t"
+		"movq %[high], %[carry]\n\t"
+		"leaq 32(%[a]), %[a]\n\t"
+		"leaq 32(%[r]), %[r]\n\t"
+		"leaq -1(%%rcx), %%rcx\n\t"
+		"jmp 3b\n\t"
+		"6:\n\t"
+		// The top word can not overflow
+		"movl $0, %k[limb]\n\t"
+		"adcxq %[limb], %[carry]\n\t"
+		"adoxq %[limb], %[carry]\n\t"
+		: [carry] "=&r"(carry), [low] "=&r"(low), [high] "=&r"(high),
+		  [limb] "=&r"(limb), [a] "+r"(a), [r] "+r"(r), "+c"(single)
+		: "d"(w), [blocks] "r"(blocks)
+		: "cc", "memory"
+	);
+	return carry;
+}
+
+// *ADDITION/SUBTRACTION*
+
+// Lanes are added without carries first. A lane generates a carry if its
+// sum wrapped around and propagates the incoming one if it is all ones.
+// With these as bit masks `(generate << 1) + propagate + carry` ripples
+// carries through the whole block in a single scalar addition: lanes
+// receiving a carry are the bits that differ from `propagate`.
+// Subtraction is the same with borrows (wrapped around and all zeros)
+
+__attribute__((target("avx512f"))) uint32_t
+addNAVX512(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n) {
+	const __m512i ones = _mm512_set1_epi32(-1);
+	uint32_t carry = 0;
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m512i x = _mm512_loadu_si512(a + i);
+		__m512i sum = _mm512_add_epi32(x, _mm512_loadu_si512(b + i));
+		uint32_t generate = _mm512_cmplt_epu32_mask(sum, x);
+		uint32_t propagate = _mm512_cmpeq_epi32_mask(sum, ones);
+		uint32_t ripple = (generate << 1) + propagate + carry;
+		__mmask16 carries = static_cast<__mmask16>(ripple ^ propagate);
+		carry = ripple >> 16;
+		// Subtracting all ones adds 1
+		sum = _mm512_mask_sub_epi32(sum, carries, sum, ones);
+		_mm512_storeu_si512(r + i, sum);
+	}
+	for (; i < n; i++) {
+		uint64_t sum = static_cast<uint64_t>(a[i]) + b[i] + carry;
+		r[i] = static_cast<uint32_t>(sum);
+		carry = static_cast<uint32_t>(sum >> 32);
+	}
+	return carry;
+}
+
+__attribute__((target("avx512f"))) uint32_t
+subNAVX512(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n) {
+	const __m512i ones = _mm512_set1_epi32(-1);
+	const __m512i zero = _mm512_setzero_si512();
+	uint32_t borrow = 0;
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m512i x = _mm512_loadu_si512(a + i);
+		__m512i diff = _mm512_sub_epi32(x, _mm512_loadu_si512(b + i));
+		uint32_t generate = _mm512_cmpgt_epu32_mask(diff, x);
+		uint32_t propagate = _mm512_cmpeq_epi32_mask(diff, zero);
+		uint32_t ripple = (generate << 1) + propagate + borrow;
+		__mmask16 borrows = static_cast<__mmask16>(ripple ^ propagate);
+		borrow = ripple >> 16;
+		diff = _mm512_mask_add_epi32(diff, borrows, diff, ones);
+		_mm512_storeu_si512(r + i, diff);
+	}
+	for (; i < n; i++) {
+		uint64_t diff = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+		r[i] = static_cast<uint32_t>(diff);
+		borrow = static_cast<uint32_t>(diff >> 63);
+	}
+	return borrow;
+}
+
+namespace {
+__attribute__((target("avx2"))) __m256i load256(const uint32_t *p) {
+	return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+__attribute__((target("avx2"))) void store256(uint32_t *p, __m256i value) {
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(p), value);
+}
+
+// Lanes of the result whose bit is set in `mask` are all ones
+__attribute__((target("avx2"))) __m256i expandMask(uint32_t mask) {
+	const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	__m256i selected =
+		_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(mask)), bits);
+	return _mm256_cmpeq_epi32(selected, bits);
+}
+
+// One bit per lane, set if `x` > `y` as unsigned numbers
+__attribute__((target("avx2"))) uint32_t greaterMask(__m256i x, __m256i y) {
+	const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+	__m256i greater = _mm256_cmpgt_epi32(
+		_mm256_xor_si256(x, bias), _mm256_xor_si256(y, bias)
+	);
+	return _mm256_movemask_ps(_mm256_castsi256_ps(greater));
+}
+
+__attribute__((target("avx2"))) uint32_t equalMask(__m256i x, __m256i y) {
+	__m256i equal = _mm256_cmpeq_epi32(x, y);
+	return _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+}
+} // namespace
+
+__attribute__((target("avx2"))) uint32_t
+addNAVX2(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n) {
+	const __m256i ones = _mm256_set1_epi32(-1);
+	uint32_t carry = 0;
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i x = load256(a + i);
+		__m256i sum = _mm256_add_epi32(x, load256(b + i));
+		uint32_t generate = greaterMask(x, sum);
+		uint32_t propagate = equalMask(sum, ones);
+		uint32_t ripple = (generate << 1) + propagate + carry;
+		carry = ripple >> 8;
+		// Subtracting all ones adds 1
+		sum = _mm256_sub_epi32(sum, expandMask(ripple ^ propagate));
+		store256(r + i, sum);
+	}
+	for (; i < n; i++) {
+		uint64_t sum = static_cast<uint64_t>(a[i]) + b[i] + carry;
+		r[i] = static_cast<uint32_t>(sum);
+		carry = static_cast<uint32_t>(sum >> 32);
+	}
+	return carry;
+}
+
+__attribute__((target("avx2"))) uint32_t
+subNAVX2(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n) {
+	const __m256i zero = _mm256_setzero_si256();
+	uint32_t borrow = 0;
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i x = load256(a + i);
+		__m256i diff = _mm256_sub_epi32(x, load256(b + i));
+		uint32_t generate = greaterMask(diff, x);
+		uint32_t propagate = equalMask(diff, zero);
+		uint32_t ripple = (generate << 1) + propagate + borrow;
+		borrow = ripple >> 8;
+		// Adding all ones subtracts 1
+		diff = _mm256_add_epi32(diff, expandMask(ripple ^ propagate));
+		store256(r + i, diff);
+	}
+	for (; i < n; i++) {
+		uint64_t diff = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+		r[i] = static_cast<uint32_t>(diff);
+		borrow = static_cast<uint32_t>(diff >> 63);
+	}
+	return borrow;
+}
+
+// *SHIFTS*
+
+// Every output limb joins two neighbouring input limbs, 8 outputs are
+// built from two overlapping loads. There is no dependency between blocks
+
+__attribute__((target("avx2"))) uint32_t shiftLeftAVX2(
+	uint32_t *r, const uint32_t *a, size_t n, unsigned shift
+) {
+	const __m128i left = _mm_cvtsi32_si128(static_cast<int>(shift));
+	const __m128i right = _mm_cvtsi32_si128(static_cast<int>(32 - shift));
+	uint32_t out = a[n - 1] >> (32 - shift);
+	// From the top, so that in place shifts read limbs before they change
+	size_t i = n;
+	for (; i >= 9; i -= 8) {
+		const uint32_t *p = a + i - 8;
+		__m256i high = load256(p);
+		__m256i low = load256(p - 1);
+		__m256i limbs = _mm256_or_si256(
+			_mm256_sll_epi32(high, left), _mm256_srl_epi32(low, right)
+		);
+		store256(r + i - 8, limbs);
+	}
+	for (; i > 1; i--)
+		r[i - 1] = (a[i - 1] << shift) | (a[i - 2] >> (32 - shift));
+	r[0] = a[0] << shift;
+	return out;
+}
+
+__attribute__((target("avx2"))) uint32_t shiftRightAVX2(
+	uint32_t *r, const uint32_t *a, size_t n, unsigned shift
+) {
+	const __m128i right = _mm_cvtsi32_si128(static_cast<int>(shift));
+	const __m128i left = _mm_cvtsi32_si128(static_cast<int>(32 - shift));
+	uint32_t out = a[0] << (32 - shift);
+	// From the bottom, so that in place shifts read limbs before they change
+	size_t i = 0;
+	for (; i + 9 <= n; i += 8) {
+		__m256i low = load256(a + i);
+		__m256i high = load256(a + i + 1);
+		__m256i limbs = _mm256_or_si256(
+			_mm256_srl_epi32(low, right), _mm256_sll_epi32(high, left)
+		);
+		store256(r + i, limbs);
+	}
+	for (; i + 1 < n; i++) r[i] = (a[i] >> shift) | (a[i + 1] << (32 - shift));
+	r[n - 1] = a[n - 1] >> shift;
+	return out;
+}
+#endif
+} // namespace LongArithm::kernels
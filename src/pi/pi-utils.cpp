@@ -1,41 +1,228 @@
 #include "pi.hpp"
+#include "../Serialization.hpp"
+#include "../kernels/kernels.hpp"
+#include <chrono>
 #include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
 
 using namespace LongArithm;
 
 namespace pi {
+namespace {
+// Every term of Chudnovsky's series adds log10(640320^3 / 1728) ~ 14.18
+// decimal digits which is slightly above 47.11 bits
+constexpr double bitsPerTerm = 47.11;
+// Ranges with fewer terms are too cheap to be split between threads
+constexpr uint64_t parallelTerms = 64;
+// With a checkpoint the terms are summed in this many consecutive segments
+// Progress is saved in between them
+constexpr uint64_t checkpointSegments = 64;
+constexpr char checkpointMagic[4] = {'P', 'I', 'C', 'K'};
+constexpr uint32_t checkpointVersion = 1;
+
+// Products over the terms [a, b) of the series
+// P = p(a) * ... * p(b - 1), Q = q(a) * ... * q(b - 1)
+// T = sum of a_k * P(a, k + 1) * Q(k + 1, b) for k in [a, b)
+struct SplitResult {
+	LongNumber P;
+	LongNumber Q;
+	LongNumber T;
+};
+
+// Products and sum over [a, c) from the ones over [a, b) and [b, c)
+SplitResult
+merge(const SplitResult &left, const SplitResult &right, bool parallel) {
+	if (!parallel)
+		return {
+			left.P * right.P, left.Q * right.Q,
+			right.Q * left.T + left.P * right.T
+		};
+	SplitResult result;
+	std::future<void> pTask =
+		kernels::spawn([&]() { result.P = left.P * right.P; });
+	std::future<void> qTask =
+		kernels::spawn([&]() { result.Q = left.Q * right.Q; });
+	result.T = right.Q * left.T + left.P * right.T;
+	pTask.get();
+	qTask.get();
+	return result;
+}
+
+// All values are integers (0 bits precision)
+SplitResult binarySplit(uint64_t a, uint64_t b) {
+	if (b - a == 1) {
+		if (a == 0) {
+			LongNumber one(1, 0);
+			return {one, one, LongNumber(13591409, 0)};
+		}
+		// C^3 / 24 = 640320^3 / 24
+		constexpr uint64_t C3_OVER_24 = 10939058860032000;
+		// Factors fit in 64 bits, only the first one becomes a `LongNumber`
+		LongNumber P = LongNumber(6 * a - 5, 0) * (2 * a - 1) * (6 * a - 1);
+		LongNumber Q = LongNumber(a * a, 0) * a * C3_OVER_24;
+		LongNumber T = P * (13591409 + 545140134 * a);
+		if (a & 1) T = -std::move(T);
+		return {std::move(P), std::move(Q), std::move(T)};
+	}
+	uint64_t m = (a + b) / 2;
+	SplitResult left, right;
+	if (b - a < parallelTerms) {
+		left = binarySplit(a, m);
+		right = binarySplit(m, b);
+		return merge(left, right, false);
+	}
+	std::future<void> leftTask =
+		kernels::spawn([&]() { left = binarySplit(a, m); });
+	right = binarySplit(m, b);
+	leftTask.get();
+	return merge(left, right, true);
+}
+
+// Sums of the terms [a, b)
+struct Range {
+	uint64_t a;
+	uint64_t b;
+	SplitResult sums;
+};
+
+// Ranges cover the terms [0, next) in order, see `calculatePi`
+struct SeriesState {
+	uint64_t terms;
+	std::vector<Range> ranges;
+
+	uint64_t next(void) const { return ranges.empty() ? 0 : ranges.back().b; }
+};
+
+// Written to a temporary file first so that a crash leaves the old one
+void writeCheckpoint(
+	const std::string &path, uint32_t precision, const SeriesState &state
+) {
+	std::string temporary = path + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		file.write(checkpointMagic, sizeof(checkpointMagic));
+		writeLittleEndian<uint32_t>(file, checkpointVersion);
+		writeLittleEndian<uint32_t>(file, precision);
+		writeLittleEndian<uint64_t>(file, state.terms);
+		writeLittleEndian<uint64_t>(file, state.ranges.size());
+		for (const Range &range : state.ranges) {
+			writeLittleEndian<uint64_t>(file, range.a);
+			writeLittleEndian<uint64_t>(file, range.b);
+			range.sums.P.serialize(file);
+			range.sums.Q.serialize(file);
+			range.sums.T.serialize(file);
+		}
+		if (!file.flush())
+			throw std::runtime_error(
+				"Failed to write checkpoint " + temporary
+			);
+	}
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	if (error)
+		throw std::runtime_error(
+			"Failed to replace checkpoint " + path + ": " + error.message()
+		);
+}
+
+SeriesState
+readCheckpoint(const std::string &path, uint32_t precision, uint64_t terms) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) throw std::runtime_error("Failed to open checkpoint " + path);
+	char magic[sizeof(checkpointMagic)] = {};
+	file.read(magic, sizeof(magic));
+	if (!std::equal(magic, magic + sizeof(magic), checkpointMagic) ||
+		readLittleEndian<uint32_t>(file) != checkpointVersion)
+		throw std::runtime_error(path + " is not a pi checkpoint");
+	if (readLittleEndian<uint32_t>(file) != precision ||
+		readLittleEndian<uint64_t>(file) != terms)
+		throw std::runtime_error(
+			"Checkpoint " + path + " was made for a different precision"
+		);
+
+	SeriesState state{terms, {}};
+	uint64_t count = readLittleEndian<uint64_t>(file);
+	for (uint64_t i = 0; i < count && file; i++) {
+		Range range;
+		range.a = readLittleEndian<uint64_t>(file);
+		range.b = readLittleEndian<uint64_t>(file);
+		if (range.a != state.next() || range.b <= range.a || range.b > terms)
+			break;
+		range.sums.P = LongNumber::deserialize(file);
+		range.sums.Q = LongNumber::deserialize(file);
+		range.sums.T = LongNumber::deserialize(file);
+		state.ranges.push_back(std::move(range));
+	}
+	if (!file || state.ranges.size() != count)
+		throw std::runtime_error("Checkpoint " + path + " is corrupted");
+	return state;
+}
+
+// pi = 426880 * sqrt(10005) * Q(0, n) / T(0, n)
+LongNumber fromSeries(const SplitResult &series, uint32_t precision) {
+	LongNumber sqrtC = LongNumber(10005, precision).sqrt();
+	return (sqrtC * 426880 * series.Q) / series.T;
+}
+} // namespace
+
 uint32_t decimalToBinaryPrecision(uint32_t decimalDigits) {
 	// Slightly above log2(10) as it was not enough
 	return std::ceil(decimalDigits * 3.35);
 }
 
 // Calculate pi using Chudnovsky's series
-// This calculates it in fixed point, using the value for one passed in
+// Sum of the series is evaluated exactly with binary splitting
 // Credits: https://www.craig-wood.com/nick/articles/pi-chudnovsky/
 LongNumber calculatePi(const uint32_t precision) {
-	LongNumber two(2, 0);
-	LongNumber six(6, 0);
-
-	LongNumber k(1);
-	LongNumber a_k = LongNumber(1, precision);
-	LongNumber a_sum = LongNumber(1, precision);
-	LongNumber b_sum = 0;
-	const LongNumber C = 640320;
-	const LongNumber C3_OVER_24 = C.pow(3) / 24;
-	while (a_k != 0) {
-		LongNumber sixK = k * six;
-		a_k *= -(sixK - 5) * (two * k - 1) * (sixK - 1);
-		a_k /= k.pow(3) * C3_OVER_24;
-		a_sum += a_k;
-		b_sum += k * a_k;
-		k += 1;
+	uint64_t terms = precision / bitsPerTerm + 2;
+	return fromSeries(binarySplit(0, terms), precision);
+}
+
+// Terms are summed segment by segment. Ranges of equal length are merged
+// right away (like digits of a binary counter), so the merges form the
+// same balanced tree as `binarySplit` and the state is O(log n) ranges
+LongNumber
+calculatePi(const uint32_t precision, const Checkpoint &checkpoint) {
+	uint64_t terms = precision / bitsPerTerm + 2;
+	uint64_t segment = (terms + checkpointSegments - 1) / checkpointSegments;
+	SeriesState state{terms, {}};
+	if (checkpoint.resume)
+		state = readCheckpoint(checkpoint.path, precision, terms);
+
+	auto lastWrite = std::chrono::steady_clock::now();
+	while (state.next() < terms || state.ranges.size() > 1) {
+		uint64_t a = state.next();
+		if (a < terms) {
+			uint64_t b = std::min(terms, a + segment);
+			state.ranges.push_back({a, b, binarySplit(a, b)});
+		}
+		// Once every term is summed the rest of the ranges are merged too
+		std::vector<Range> &ranges = state.ranges;
+		while (ranges.size() > 1 &&
+			   (state.next() == terms ||
+				ranges.back().b - ranges.back().a ==
+					ranges.end()[-2].b - ranges.end()[-2].a)) {
+			Range right = std::move(ranges.back());
+			ranges.pop_back();
+			ranges.back().sums = merge(ranges.back().sums, right.sums, true);
+			ranges.back().b = right.b;
+		}
+
+		std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - lastWrite;
+		if (elapsed.count() >= checkpoint.intervalSeconds) {
+			writeCheckpoint(checkpoint.path, precision, state);
+			lastWrite = std::chrono::steady_clock::now();
+			if (checkpoint.onSave) checkpoint.onSave(state.next(), terms);
+		}
 	}
-	LongNumber total = a_sum * 13591409 + b_sum * 545140134;
-	LongNumber pi =
-		(426880.0_longnum * (10005.0_longnum).withPrecision(precision).sqrt()) /
-		total;
+
+	LongNumber pi = fromSeries(state.ranges.back().sums, precision);
+	std::error_code error;
+	std::filesystem::remove(checkpoint.path, error);
 	return pi;
 }
 } // namespace pi
@@ -1,27 +1,115 @@
+#include "../Stats.hpp"
 #include "pi.hpp"
+#include <charconv>
 #include <cmath>
+#include <fstream>
 
+namespace {
+// Returns 0 if `arg` is not a positive integer
+unsigned parseCount(const std::string &arg, const std::string &name) {
+	unsigned count = 0;
+	const char *end = arg.data() + arg.size();
+	auto [last, error] = std::from_chars(arg.data(), end, count);
+	if (error != std::errc() || last != end || count == 0) {
+		std::cerr << "Invalid " << name << ": " << arg << '\n';
+		return 0;
+	}
+	return count;
+}
+} // namespace
+
+// Usage: calc-pi <digits> [--threads N] [--output FILE] [--stats]
+//                [--checkpoint FILE [--checkpoint-interval SECONDS]
+//                [--resume]] [--cpu generic|bmi2|avx2|avx512]
+// Digits go to stdout unless `--output` is given
+// `--stats` prints operation counters to stderr (needs a `STATS=1` build)
+// `--checkpoint` saves the progress every 60 seconds (or the given
+// interval), `--resume` continues from the saved progress
+// `--cpu` forces a kernel tier below the detected one
 int main(int argc, char **argv) {
 	if (argc < 2) {
 		std::cerr << "Precision must be specified for the program to run\n";
 		return 1;
 	}
-	const std::string arg = argv[1];
-	int precision = 0;
-	try {
-		precision = std::stoi(arg);
-	} catch (const std::invalid_argument &ex) {
-		std::cerr << "Invalid precision: " << arg << '\n';
-	} catch (const std::out_of_range &ex) {
-		std::cerr << "Precision out of range: " << arg << '\n';
+	unsigned precision = parseCount(argv[1], "precision");
+	if (precision == 0) return 1;
+
+	bool stats = false;
+	std::ofstream file;
+	pi::Checkpoint checkpoint;
+	for (int i = 2; i < argc; i++) {
+		const std::string option = argv[i];
+		if (option == "--stats") {
+			stats = true;
+			continue;
+		}
+		if (option == "--resume") {
+			checkpoint.resume = true;
+			continue;
+		}
+		if (i + 1 == argc) {
+			std::cerr << "Missing value for option: " << option << '\n';
+			return 1;
+		}
+		const std::string value = argv[++i];
+		if (option == "--output") {
+			// Opened upfront so that a bad path fails before the computation
+			file.open(value);
+			if (!file) {
+				std::cerr << "Failed to open " << value << '\n';
+				return 1;
+			}
+		} else if (option == "--checkpoint") {
+			checkpoint.path = value;
+		} else if (option == "--checkpoint-interval") {
+			unsigned seconds = parseCount(value, "checkpoint interval");
+			if (seconds == 0) return 1;
+			checkpoint.intervalSeconds = seconds;
+		} else if (option == "--threads") {
+			unsigned threads = parseCount(value, "thread count");
+			if (threads == 0) return 1;
+			LongArithm::setThreadCount(threads);
+		} else if (option == "--cpu") {
+			std::optional<LongArithm::CpuTier> tier =
+				LongArithm::parseCpuTier(value);
+			if (!tier || *tier > LongArithm::detectCpuTier()) {
+				std::cerr << "Unsupported CPU tier: " << value << '\n';
+				return 1;
+			}
+			LongArithm::setCpuTier(*tier);
+		} else {
+			std::cerr << "Unknown option: " << option << '\n';
+			return 1;
+		}
 	}
+	if (checkpoint.resume && checkpoint.path.empty()) {
+		std::cerr << "--resume requires --checkpoint FILE\n";
+		return 1;
+	}
+	checkpoint.onSave = [](uint64_t terms, uint64_t totalTerms) {
+		std::cerr << "Checkpoint saved: " << terms << '/' << totalTerms
+				  << " terms\n";
+	};
 
-	if (precision <= 0) {
-		std::cerr << "Precision must be > 0\n";
+	// Reuse storage of the temporaries
+	LongArithm::ArenaScope arena;
+	uint32_t bits = pi::decimalToBinaryPrecision(precision);
+	LongArithm::LongNumber pi;
+	try {
+		pi = checkpoint.path.empty() ? pi::calculatePi(bits)
+									 : pi::calculatePi(bits, checkpoint);
+	} catch (const std::runtime_error &ex) {
+		std::cerr << ex.what() << '\n';
+		return 1;
+	}
+	// Digits are written as they are converted instead of as one string
+	std::ostream &out = file.is_open() ? file : std::cout;
+	pi.writeString(out, precision);
+	out << '\n';
+	if (!out.flush()) {
+		std::cerr << "Failed to write the digits\n";
 		return 1;
 	}
-	LongArithm::LongNumber pi =
-		pi::calculatePi(pi::decimalToBinaryPrecision(precision));
-	std::cout << pi.toString(precision) << '\n';
+	if (stats) LongArithm::stats::dump(std::cerr);
 	return 0;
-}
\ No newline at end of file
+}
@@ -3,10 +3,29 @@
 
 #include "../LongArithm.hpp"
 #include <cinttypes>
+#include <functional>
+#include <string>
 
 namespace pi {
 uint32_t decimalToBinaryPrecision(uint32_t decimalDigits);
 LongArithm::LongNumber calculatePi(const uint32_t precision);
+
+// Periodically saves the progress of `calculatePi` to a file
+struct Checkpoint {
+	std::string path;
+	// Minimum time between two writes
+	double intervalSeconds = 60;
+	// Continue from `path` instead of starting over
+	bool resume = false;
+	// Called after every write with the number of terms summed so far
+	std::function<void(uint64_t terms, uint64_t totalTerms)> onSave;
+};
+// Same result as `calculatePi(precision)`. The file is replaced atomically
+// and removed once pi is computed
+// Throws `std::runtime_error` if the file cannot be written, or if
+// resuming from a missing file or one made for a different precision
+LongArithm::LongNumber
+calculatePi(const uint32_t precision, const Checkpoint &checkpoint);
 } // namespace pi
 
 #endif
\ No newline at end of file
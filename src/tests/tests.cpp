@@ -1,8 +1,14 @@
+#include "../BigFloat.hpp"
 #include "../LongArithm.hpp"
+#include "../MappedNumber.hpp"
+#include "../Stats.hpp"
 #include "../pi/pi.hpp"
 #include "Tester.hpp"
 #include "utils.hpp"
+#include <filesystem>
+#include <fstream>
 #include <limits>
+#include <thread>
 #include <stdio.h>
 
 using namespace LongArithm;
@@ -127,6 +133,83 @@ int main(void) {
 
 	success &= testerStr.runTests();
 
+	// -------------------------------------------------------------------
+	test::Tester testerDecimalStr("Decimal string constructor");
+	testerDecimalStr.registerTest(
+		isEquals(
+			LongNumber::fromDecimalString("123456789012345678901234567890", 0)
+				.toString(),
+			std::string("123456789012345678901234567890")
+		),
+		"Integer (multiple chunks)"
+	);
+	testerDecimalStr.registerTest(
+		isEquals(LongNumber::fromDecimalString("-10.625"), -10.625_longnum),
+		"-10.625"
+	);
+	testerDecimalStr.registerTest(
+		isEquals(LongNumber::fromDecimalString("+1.5e3", 0), LongNumber(1500)),
+		"+1.5e3 = 1500"
+	);
+	testerDecimalStr.registerTest(
+		isEquals(LongNumber::fromDecimalString("25E-2"), 0.25_longnum),
+		"25E-2 = 0.25"
+	);
+	testerDecimalStr.registerTest(
+		isEquals(
+			LongNumber::fromDecimalString("0.1", 4).toBinaryString(),
+			std::string(".0010")
+		),
+		"0.1 (precision = 4) rounds up"
+	);
+	testerDecimalStr.registerTest(
+		isEquals(
+			LongNumber::fromDecimalString("0.09375", 4).toBinaryString(),
+			std::string(".0010")
+		),
+		"0.09375 (precision = 4) tie rounds to even"
+	);
+	testerDecimalStr.registerTest(
+		isEquals(
+			LongNumber::fromDecimalString("-0.03125", 4),
+			LongNumber(0.0L, 4)
+		),
+		"-0.03125 (precision = 4) rounds to 0"
+	);
+	testerDecimalStr.registerTest(
+		[]() {
+			// Long enough to be split by powers of 10
+			std::string digits = LongNumber(3, 0).pow(20000).toString();
+			return LongNumber::fromDecimalString(digits, 0) ==
+				   LongNumber(3, 0).pow(20000);
+		},
+		"3 ^ 20000 round trip"
+	);
+	testerDecimalStr.registerTest(
+		[]() {
+			// 2 ^ (-3000) is exact with 3000 bits
+			LongNumber x = LongNumber(1, 3000) >> 3000;
+			return LongNumber::fromDecimalString(x.toString(3000), 3000) == x;
+		},
+		"2 ^ (-3000) round trip"
+	);
+	testerDecimalStr.registerTest(
+		[]() {
+			// 10^(-19) = 1.84 * 2^(-64) is the smallest power kept
+			return LongNumber::fromDecimalString("1e-2000000000", 64) ==
+					   LongNumber(0.0L, 64) &&
+				   LongNumber::fromDecimalString("-5e-30", 64) ==
+					   LongNumber(0.0L, 64) &&
+				   LongNumber::fromDecimalString("1e-19", 64) ==
+					   (LongNumber(1, 64) >> 63) &&
+				   LongNumber::fromDecimalString("1e-20", 64) ==
+					   LongNumber(0.0L, 64);
+		},
+		"Tiny exponents round to 0 right away"
+	);
+
+	success &= testerDecimalStr.runTests();
+
 	// -------------------------------------------------------------------
 	test::Tester testerSpaceshipBasic("Comparisons one chunk int");
 	testerSpaceshipBasic.registerTest(
@@ -219,6 +302,43 @@ int main(void) {
 		[]() { return LongNumber(1.25L, 320) == LongNumber(1.25L); },
 		"Equal numbers with different precision"
 	);
+	testerSpaceshipAdvanced.registerTest(
+		[]() {
+			// 4 fraction bits, the rest of the lowest chunk is ignored
+			std::vector<uint32_t> limbs = {0x8FFFFFFF, 1};
+			return LongNumber::fromLimbs(limbs, false, 4) == LongNumber(1.5L);
+		},
+		"Bits below precision are ignored"
+	);
+	testerSpaceshipAdvanced.registerTest(
+		[]() {
+			return LongNumber(1.5L, 320) > LongNumber(1.25L, 32) &&
+				   LongNumber(1.25L, 32) < LongNumber(1.5L, 320) &&
+				   LongNumber(0.0L, 320) == LongNumber(0.0L, 0);
+		},
+		"Different precision in both directions"
+	);
+	testerSpaceshipAdvanced.registerTest(
+		[]() {
+			std::vector<uint32_t> limbs(37, 0xFFFFFFFF);
+			LongNumber a = LongNumber::fromLimbs(limbs, false, 0);
+			limbs[1]--;
+			LongNumber b = LongNumber::fromLimbs(limbs, false, 0);
+			return a > b && b < a && a != b;
+		},
+		"Long equal prefix"
+	);
+	testerSpaceshipAdvanced.registerTest(
+		[]() {
+			return LongNumber(-3).compareAbs(LongNumber(2)) ==
+					   std::strong_ordering::greater &&
+				   LongNumber(-2).compareAbs(LongNumber(2)) ==
+					   std::strong_ordering::equal &&
+				   LongNumber(0.5L).compareAbs(LongNumber(-0.75L)) ==
+					   std::strong_ordering::less;
+		},
+		"compareAbs ignores signs"
+	);
 	success &= testerSpaceshipAdvanced.runTests();
 
 	test::Tester testerShifts("Bitwise shifts <<=, =>>");
@@ -274,6 +394,15 @@ int main(void) {
 		},
 		"1 << 2 == 4"
 	);
+	testerShifts.registerTest(
+		[]() {
+			// Leading zero fraction chunks become whole chunks
+			LongNumber x = LongNumber(1, 96) >> 80;
+			return (x << 160) > LongNumber(1, 0) << 79 &&
+				   (x << 160) < LongNumber(1, 0) << 81;
+		},
+		"2^-80 << 160 compares as 2^80"
+	);
 	testerShifts.registerTest(
 		[]() {
 			LongNumber x(4);
@@ -281,6 +410,31 @@ int main(void) {
 		},
 		"4 >> 2 == 1"
 	);
+	testerShifts.registerTest(
+		[]() {
+			std::vector<uint32_t> limbs(101);
+			for (size_t i = 0; i < limbs.size(); i++)
+				limbs[i] = 0x9E3779B9 * static_cast<uint32_t>(i + 1);
+			LongNumber x = LongNumber::fromLimbs(limbs, false, 0);
+			return (x << 13) == x * 8192 && ((x << 13) >> 13) == x &&
+				   (x >> 7) << 7 == x - LongNumber(limbs[0] & 127, 0);
+		},
+		"Long operands (vector kernels)"
+	);
+	testerShifts.registerTest(
+		[]() {
+			LongNumber x = LongNumber(7, 64).pow(200), y = x;
+			for (int i = 0; i < 50; i++) {
+				y <<= 32 * (i % 3);
+				y >>= 32 * ((i + 1) % 3);
+				y <<= 32 * ((i + 1) % 3);
+				y >>= 32 * (i % 3);
+			}
+			return y == x && (x << 320) >> 320 == x &&
+				   (x >> 64) << 64 == x.withPrecision(0).withPrecision(64);
+		},
+		"Whole chunk shifts back and forth"
+	);
 
 	success &= testerShifts.runTests();
 
@@ -331,6 +485,49 @@ int main(void) {
 		"2.25 + 2 = 4.25 (different precision)"
 	);
 
+	testerAddition.registerTest(
+		isEquals(
+			(LongNumber(1, 0) << 40) + 0.5_longnum,
+			LongNumber(1099511627776.5L)
+		),
+		"2^40 + 0.5 (fraction chunks added to the larger number)"
+	);
+	testerAddition.registerTest(
+		isEquals(LongNumber(5, 0) - 0.5_longnum, 4.5_longnum),
+		"5 - 0.5 = 4.5 (different precision)"
+	);
+	testerAddition.registerTest(
+		isEquals(LongNumber(-5) - LongNumber(-3), LongNumber(-2)),
+		"(-5) - (-3) = -2"
+	);
+	testerAddition.registerTest(
+		isEquals(LongNumber(-3) - LongNumber(-5), LongNumber(2)),
+		"(-3) - (-5) = 2"
+	);
+	testerAddition.registerTest(
+		[]() {
+			// Carries and borrows run through every limb
+			std::vector<uint32_t> ones(100, UINT32_MAX);
+			LongNumber x = LongNumber::fromLimbs(ones, false, 0);
+			LongNumber power = LongNumber(1, 0) << 3200;
+			return x + LongNumber(1, 0) == power &&
+				   power - LongNumber(1, 0) == x && power - x == LongNumber(1);
+		},
+		"Carry through 100 limbs"
+	);
+	testerAddition.registerTest(
+		[]() {
+			std::vector<uint32_t> a(77), b(77);
+			for (size_t i = 0; i < a.size(); i++) {
+				a[i] = i % 3 == 0 ? UINT32_MAX : 0x9E3779B9 * (i + 1);
+				b[i] = i % 5 == 0 ? 0 : ~a[i];
+			}
+			LongNumber x = LongNumber::fromLimbs(a, false, 0);
+			LongNumber y = LongNumber::fromLimbs(b, false, 0);
+			return x + y - y == x && x - y + y == x && (x + y) - x == y;
+		},
+		"a + b - b = a (long operands)"
+	);
 	success &= testerAddition.runTests();
 
 	// -------------------------------------------------------------------
@@ -389,6 +586,123 @@ int main(void) {
 
 	success &= testerMultiplication.runTests();
 
+	// -------------------------------------------------------------------
+	test::Tester testerMulAlgorithms("Multiplication algorithms");
+	// Multiplies using the given thresholds, restores defaults afterwards
+	auto mulWith = [](const LongNumber &a, const LongNumber &b,
+					  MultiplicationThresholds thresholds) {
+		MultiplicationThresholds defaults = getMultiplicationThresholds();
+		setMultiplicationThresholds(thresholds);
+		LongNumber result = a * b;
+		setMultiplicationThresholds(defaults);
+		return result;
+	};
+	const MultiplicationThresholds schoolbook = {100000, 100000, 100000};
+	const MultiplicationThresholds karatsuba = {4, 100000, 100000};
+	const MultiplicationThresholds toom3 = {4, 8, 100000};
+	const MultiplicationThresholds ntt = {4, 8, 16};
+	const LongNumber bigA = LongNumber(3, 0).pow(4000);
+	const LongNumber bigB = LongNumber(7, 0).pow(2500) - LongNumber(1, 0);
+	const LongNumber smallB = LongNumber(11, 0).pow(100);
+
+	testerMulAlgorithms.registerTest(
+		[=]() {
+			return mulWith(bigA, bigB, karatsuba) ==
+				   mulWith(bigA, bigB, schoolbook);
+		},
+		"Karatsuba = schoolbook"
+	);
+	testerMulAlgorithms.registerTest(
+		[=]() {
+			return mulWith(bigA, bigB, toom3) ==
+				   mulWith(bigA, bigB, schoolbook);
+		},
+		"Toom-3 = schoolbook"
+	);
+	testerMulAlgorithms.registerTest(
+		[=]() {
+			return mulWith(bigA, bigB, ntt) == mulWith(bigA, bigB, schoolbook);
+		},
+		"NTT = schoolbook"
+	);
+	testerMulAlgorithms.registerTest(
+		[=]() {
+			return mulWith(bigA, smallB, toom3) ==
+				   mulWith(bigA, smallB, schoolbook);
+		},
+		"Unbalanced operands"
+	);
+	testerMulAlgorithms.registerTest(
+		[=]() {
+			LongNumber a = bigA.withPrecision(1000) >> 1000;
+			LongNumber b = -bigB.withPrecision(700) >> 700;
+			return mulWith(a, b, toom3) == mulWith(a, b, schoolbook);
+		},
+		"Toom-3 = schoolbook (fraction, negative)"
+	);
+	testerMulAlgorithms.registerTest(
+		[=]() {
+			// (2^3000 - 1)^2 = 2^6000 - 2^3001 + 1
+			LongNumber x = (LongNumber(1, 0) << 3000) - LongNumber(1, 0);
+			LongNumber expected = (LongNumber(1, 0) << 6000) -
+								  (LongNumber(1, 0) << 3001) +
+								  LongNumber(1, 0);
+			return mulWith(x, x, toom3) == expected;
+		},
+		"(2^3000 - 1)^2 (all ones operands)"
+	);
+	testerMulAlgorithms.registerTest(
+		[=]() {
+			// Largest possible limbs maximize convolution coefficients
+			LongNumber x = (LongNumber(1, 0) << 64000) - LongNumber(1, 0);
+			LongNumber expected = (LongNumber(1, 0) << 128000) -
+								  (LongNumber(1, 0) << 64001) +
+								  LongNumber(1, 0);
+			return mulWith(x, x, ntt) == expected;
+		},
+		"(2^64000 - 1)^2 using NTT"
+	);
+	// Distinct operands force the general multiplication
+	auto squareWith = [](const LongNumber &a,
+						 MultiplicationThresholds thresholds) {
+		MultiplicationThresholds defaults = getMultiplicationThresholds();
+		setMultiplicationThresholds(thresholds);
+		LongNumber result = a.square();
+		setMultiplicationThresholds(defaults);
+		return result;
+	};
+	const LongNumber fracB = -bigB.withPrecision(700) >> 700;
+	testerMulAlgorithms.registerTest(
+		[=]() {
+			return squareWith(fracB, schoolbook) ==
+				   mulWith(fracB, LongNumber(fracB), schoolbook);
+		},
+		"Schoolbook squaring (fraction, negative)"
+	);
+	testerMulAlgorithms.registerTest(
+		[=]() {
+			return squareWith(bigB, karatsuba) ==
+				   mulWith(bigB, LongNumber(bigB), schoolbook);
+		},
+		"Karatsuba squaring"
+	);
+	testerMulAlgorithms.registerTest(
+		[=]() {
+			return squareWith(fracB, toom3) ==
+				   mulWith(fracB, LongNumber(fracB), schoolbook);
+		},
+		"Toom-3 squaring (fraction, negative)"
+	);
+	testerMulAlgorithms.registerTest(
+		[=]() {
+			return squareWith(bigA, ntt) ==
+				   mulWith(bigA, LongNumber(bigA), schoolbook);
+		},
+		"NTT squaring"
+	);
+
+	success &= testerMulAlgorithms.runTests();
+
 	// -------------------------------------------------------------------
 	test::Tester testerDivision("Operator /");
 	testerDivision.registerTest(
@@ -423,6 +737,47 @@ int main(void) {
 	);
 	success &= testerDivision.runTests();
 
+	// -------------------------------------------------------------------
+	test::Tester testerDivAlgorithms("Division algorithms");
+	testerDivAlgorithms.registerTest(
+		[=]() {
+			// Single chunk divisor
+			LongNumber product = bigA * LongNumber(12345, 0);
+			return product / LongNumber(12345, 0) == bigA;
+		},
+		"(a * 12345) / 12345 = a"
+	);
+	testerDivAlgorithms.registerTest(
+		[=]() { return (bigA * smallB) / smallB == bigA; },
+		"(a * b) / b = a (Knuth)"
+	);
+	testerDivAlgorithms.registerTest(
+		[=]() { return (bigA * bigB) / bigB == bigA; },
+		"(a * b) / b = a (Newton)"
+	);
+	testerDivAlgorithms.registerTest(
+		[=]() {
+			// Quotient is truncated, the remainder must lie in [0, b)
+			LongNumber a = bigA.withPrecision(0) * bigB.withPrecision(0) +
+						   bigB.withPrecision(0) - LongNumber(1, 0);
+			LongNumber b = bigB.withPrecision(0);
+			LongNumber q = a / b;
+			LongNumber r = a - q * b;
+			return q == bigA && r >= LongNumber(0, 0) && r < b;
+		},
+		"Remainder is in [0, b) (Newton)"
+	);
+	testerDivAlgorithms.registerTest(
+		[=]() {
+			// 2^-6000 / 2^-3000 with fraction only operands
+			LongNumber a = LongNumber(1, 7000) >> 6000;
+			LongNumber b = -(LongNumber(1, 7000) >> 3000);
+			return a / b == -(LongNumber(1, 7000) >> 3000);
+		},
+		"Fraction only operands"
+	);
+	success &= testerDivAlgorithms.runTests();
+
 	// -------------------------------------------------------------------
 	test::Tester testerCompoundArithmetics("Compound assignment");
 	testerCompoundArithmetics.registerTest(
@@ -454,9 +809,86 @@ int main(void) {
 	testerCompoundArithmetics.registerTest(
 		isEquals(LongNumber(2) *= -2, LongNumber(-4)), "2 *= -2"
 	);
+	testerCompoundArithmetics.registerTest(
+		isEquals(LongNumber(7) /= -2, LongNumber(-3.5L)), "7 /= -2"
+	);
+	testerCompoundArithmetics.registerTest(
+		isEquals(LongNumber(1, 0) += 0.5_longnum, 1.5_longnum),
+		"1 (precision 0) += 0.5"
+	);
+	testerCompoundArithmetics.registerTest(
+		isEquals(
+			LongNumber("1" + std::string(64, '0'), 0) -=
+			LongNumber("1" + std::string(70, '0'), 0),
+			-LongNumber(std::string(6, '1') + std::string(64, '0'), 0)
+		),
+		"2^64 -= 2^70 (sign flips, multiple chunks)"
+	);
+	testerCompoundArithmetics.registerTest(
+		[]() {
+			LongNumber x = 2.5_longnum;
+			x += x;
+			return x == 5.0_longnum;
+		},
+		"x += x"
+	);
+	testerCompoundArithmetics.registerTest(
+		[]() {
+			LongNumber x = -2.5_longnum;
+			x -= x;
+			return x == LongNumber(0) && -x == LongNumber(0);
+		},
+		"x -= x is +0"
+	);
 
 	success &= testerCompoundArithmetics.runTests();
 
+	// -------------------------------------------------------------------
+	test::Tester testerIntegerOperands("Integer operands");
+	testerIntegerOperands.registerTest(
+		isEquals(2.5_longnum + 3, 5.5_longnum), "2.5 + 3"
+	);
+	testerIntegerOperands.registerTest(
+		isEquals(2.5_longnum - 3, -0.5_longnum), "2.5 - 3 (sign flips)"
+	);
+	testerIntegerOperands.registerTest(
+		isEquals(-3 * 2.5_longnum, -7.5_longnum), "-3 * 2.5"
+	);
+	testerIntegerOperands.registerTest(
+		isEquals(7.5_longnum / -2, -3.75_longnum), "7.5 / -2"
+	);
+	testerIntegerOperands.registerTest(
+		isEquals(LongNumber(7, 0) / 2, LongNumber(3, 0)),
+		"7 (precision 0) / 2 keeps precision"
+	);
+	testerIntegerOperands.registerTest(
+		[]() {
+			LongNumber x = 3.0_longnum;
+			x -= 3;
+			return x == 0.0_longnum && -x == 0.0_longnum;
+		},
+		"3 -= 3 is +0"
+	);
+	testerIntegerOperands.registerTest(
+		[]() {
+			const uint64_t c = 10939058860032000;
+			LongNumber x = LongNumber(c, 0) * c * c;
+			return x == LongNumber(c, 0).pow(3) &&
+				   x / c / c == LongNumber(c, 0);
+		},
+		"64 bit operands"
+	);
+	testerIntegerOperands.registerTest(
+		[]() {
+			LongNumber x = LongNumber(1, 0) << 200;
+			x += std::numeric_limits<int64_t>::min();
+			x -= std::numeric_limits<int64_t>::min();
+			return x == LongNumber(1, 0) << 200;
+		},
+		"Adding and subtracting INT64_MIN"
+	);
+	success &= testerIntegerOperands.runTests();
+
 	// -------------------------------------------------------------------
 	test::Tester testerExcep("Exceptions");
 	testerExcep.registerTest(
@@ -494,6 +926,14 @@ int main(void) {
 		},
 		"x / 0 = Error", true
 	);
+	testerExcep.registerTest(
+		[]() {
+			LongNumber x(32);
+			x /= 0U;
+			return true;
+		},
+		"x /= 0U = Error", true
+	);
 	testerExcep.registerTest(
 		[]() {
 			LongNumber(-5).sqrt();
@@ -501,6 +941,20 @@ int main(void) {
 		},
 		"sqrt(-5) = Error", true
 	);
+	testerExcep.registerTest(
+		[]() {
+			LongNumber(8).nthRoot(0);
+			return true;
+		},
+		"nthRoot(8, 0) = Error", true
+	);
+	testerExcep.registerTest(
+		[]() {
+			LongNumber(-16).nthRoot(4);
+			return true;
+		},
+		"nthRoot(-16, 4) = Error", true
+	);
 	testerExcep.registerTest(
 		[]() {
 			LongNumber("");
@@ -508,6 +962,34 @@ int main(void) {
 		},
 		"Initializing from an empty string", true
 	);
+	testerExcep.registerTest(
+		[]() {
+			LongNumber::fromDecimalString("1.2.3");
+			return true;
+		},
+		"Two decimal points", true
+	);
+	testerExcep.registerTest(
+		[]() {
+			LongNumber::fromDecimalString("1e");
+			return true;
+		},
+		"Exponent without digits", true
+	);
+	testerExcep.registerTest(
+		[]() {
+			LongNumber::fromDecimalString("1e2000000000", 0);
+			return true;
+		},
+		"Huge exponent", true
+	);
+	testerExcep.registerTest(
+		[]() {
+			LongNumber::fromDecimalString("-.");
+			return true;
+		},
+		"Decimal string without digits", true
+	);
 	testerExcep.registerTest(
 		[]() {
 			LongNumber obj(10, 0);
@@ -554,6 +1036,34 @@ int main(void) {
 		},
 		"long double min copy (multiple chunks)"
 	);
+	testerAssignment.registerTest(
+		[]() {
+			LongNumber x = LongNumber(std::numeric_limits<long double>::min());
+			LongNumber copy = x;
+			LongNumber test(std::move(x));
+			x = copy;
+			return test == copy && x == copy;
+		},
+		"Move and assign back to a moved from number"
+	);
+	testerAssignment.registerTest(
+		[]() {
+			LongNumber x = 2.5_longnum;
+			return LongNumber(2) + x == 4.5_longnum &&
+				   x + LongNumber(2) == 4.5_longnum &&
+				   LongNumber(2) + LongNumber(x) == 4.5_longnum;
+		},
+		"Addition with expiring operands"
+	);
+	testerAssignment.registerTest(
+		[]() {
+			LongNumber x = 2.5_longnum;
+			return LongNumber(2) - x == -0.5_longnum &&
+				   x - LongNumber(2) == 0.5_longnum &&
+				   LongNumber(2) - LongNumber(x) == -0.5_longnum;
+		},
+		"Subtraction with expiring operands"
+	);
 
 	success &= testerAssignment.runTests();
 
@@ -618,6 +1128,22 @@ int main(void) {
 		isEquals(LongNumber(0.5L, 32).withPrecision(96), LongNumber(0.5L)),
 		"Raise precision | withPrecision"
 	);
+	testerPrecision.registerTest(
+		[]() {
+			// Chunks are dropped and added back at the front of the window
+			LongNumber x = LongNumber(3, 320).pow(100);
+			LongNumber expected = x;
+			for (uint32_t precision = 320; precision > 0; precision -= 32) {
+				x.setPrecision(precision);
+				x.setPrecision(precision + 200);
+				x.setPrecision(precision - 32);
+			}
+			x.setPrecision(320);
+			x += LongNumber(1, 0) << 2000;
+			return x - (LongNumber(1, 0) << 2000) == expected;
+		},
+		"Repeated precision changes of a long number"
+	);
 
 	success &= testerPrecision.runTests();
 
@@ -662,6 +1188,49 @@ int main(void) {
 		isEquals(LongNumber(0.25).sqrt(), LongNumber(0.5)),
 		"sqrt(0.5 ^ 2) = 0.5"
 	);
+	testerSqrt.registerTest(
+		[]() {
+			LongNumber x = LongNumber(3, 0).pow(400);
+			return x.square().sqrt() == x;
+		},
+		"sqrt(3 ^ 800) = 3 ^ 400"
+	);
+	testerSqrt.registerTest(
+		[]() {
+			LongNumber x = LongNumber(3, 0).pow(400);
+			return (x.square() - 1).sqrt() == x - 1;
+		},
+		"sqrt(3 ^ 800 - 1) = 3 ^ 400 - 1 (truncated)"
+	);
+	testerSqrt.registerTest(
+		[]() {
+			LongNumber root = LongNumber(2, 256).sqrt();
+			LongNumber ulp = LongNumber(1, 256) >> 256;
+			LongNumber two(2, 1024);
+			return root.withPrecision(1024).square() <= two &&
+				   (root + ulp).withPrecision(1024).square() > two;
+		},
+		"sqrt(2) is truncated to the last bit"
+	);
+	testerSqrt.registerTest(
+		isEquals(LongNumber(27, 0).nthRoot(3), LongNumber(3, 0)),
+		"nthRoot(27, 3) = 3"
+	);
+	testerSqrt.registerTest(
+		isEquals(LongNumber(-8).nthRoot(3), LongNumber(-2)),
+		"nthRoot(-8, 3) = -2"
+	);
+	testerSqrt.registerTest(
+		isEquals(LongNumber(0.0625).nthRoot(4), LongNumber(0.5)),
+		"nthRoot(0.5 ^ 4, 4) = 0.5"
+	);
+	testerSqrt.registerTest(
+		[]() {
+			LongNumber x = LongNumber(7, 0).pow(123);
+			return x.pow(7).nthRoot(7) == x && (x.pow(7) - 1).nthRoot(7) < x;
+		},
+		"nthRoot(7 ^ 861, 7) = 7 ^ 123"
+	);
 
 	success &= testerSqrt.runTests();
 
@@ -703,8 +1272,349 @@ int main(void) {
 		),
 		"2 ^ (50) + 0.25"
 	);
+	testerToString.registerTest(
+		isEquals(
+			LongNumber(10, 0).pow(1000).toString(),
+			"1" + std::string(1000, '0')
+		),
+		"10 ^ 1000 (zeros inside the split)"
+	);
+	testerToString.registerTest(
+		isEquals(
+			(LongNumber(10, 0).pow(1000) - LongNumber(1, 0)).toString(),
+			std::string(1000, '9')
+		),
+		"10 ^ 1000 - 1"
+	);
+	testerToString.registerTest(
+		[]() {
+			// 2 ^ (-n) has exactly n digits after the decimal point
+			std::string output =
+				(LongNumber(1, 3000) >> 3000).toString(5000);
+			return output.size() == 3001 && output.back() == '5' &&
+				   output.starts_with(".000000000");
+		},
+		"2 ^ (-3000) (all digits)"
+	);
+	testerToString.registerTest(
+		isEquals(
+			(LongNumber(1, 3000) >> 3000).toString(900),
+			"." + std::string(900, '0')
+		),
+		"2 ^ (-3000) (zeros only)"
+	);
+	// Concatenated blocks, empty if any block is longer than `limit`
+	auto streamed = [](const LongNumber &x, uint32_t digits, size_t limit) {
+		std::string output;
+		bool fits = true;
+		x.writeString(
+			[&](std::string_view block) {
+				fits &= block.size() <= limit;
+				output += block;
+			},
+			digits, limit
+		);
+		return fits ? output : std::string();
+	};
+	testerToString.registerTest(
+		[=]() {
+			LongNumber x = pi::calculatePi(pi::decimalToBinaryPrecision(2000));
+			return streamed(x, 2000, 10) == x.toString(2000) &&
+				   streamed(-x, 2000, 1) == (-x).toString(2000);
+		},
+		"Streamed 2000 digits of pi match toString"
+	);
+	testerToString.registerTest(
+		[=]() {
+			LongNumber x = LongNumber(10, 0).pow(1000);
+			return streamed(x, 8, 100) == x.toString() &&
+				   streamed(x - 1, 8, 100) == std::string(1000, '9') &&
+				   streamed(LongNumber(0, 0), 8, 1) == "0";
+		},
+		"Streamed integers (leading zeros across blocks)"
+	);
+	testerToString.registerTest(
+		[=]() {
+			LongNumber x = LongNumber(1, 3000) >> 3000;
+			return streamed(x, 5000, 64) == x.toString(5000) &&
+				   streamed(x, 900, 64) == "." + std::string(900, '0') &&
+				   streamed(0.5_longnum, 5000, 64) == ".5" &&
+				   streamed(-0.0009765625_longnum, 8, 3) == "-.00097656";
+		},
+		"Streamed fractions (trailing zeros across blocks)"
+	);
+	testerToString.registerTest(
+		[]() {
+			std::ostringstream output;
+			LongNumber x = LongNumber(3, 0).pow(2000) + 0.25_longnum;
+			x.writeString(output, 5, 100);
+			return output.str() == x.toString(5);
+		},
+		"Stream to std::ostream"
+	);
 	success &= testerToString.runTests();
 
+	// -------------------------------------------------------------------
+	test::Tester testerSerialization("Binary serialization");
+	// Equal values with the same precision
+	auto roundTrip = [](const LongNumber &x) {
+		std::stringstream buffer;
+		x.serialize(buffer);
+		LongNumber y = LongNumber::deserialize(buffer);
+		return y == x && y.toBinaryString() == x.toBinaryString() &&
+			   buffer.peek() == EOF;
+	};
+	testerSerialization.registerTest(
+		[=]() {
+			return roundTrip(LongNumber()) && roundTrip(LongNumber(0, 0)) &&
+				   roundTrip(-10.625_longnum) && roundTrip(LongNumber(1, 0));
+		},
+		"Small numbers"
+	);
+	testerSerialization.registerTest(
+		[=]() {
+			LongNumber x = LongNumber(3, 100).pow(3000) / LongNumber(7, 0);
+			return roundTrip(x) && roundTrip(-x) && roundTrip(x >> 5000);
+		},
+		"Large numbers with fraction"
+	);
+	testerSerialization.registerTest(
+		[]() {
+			std::stringstream buffer;
+			(-2.5_longnum).serialize(buffer);
+			const std::string bytes = buffer.str();
+			// Magic, version 1, 96 fraction bits, sign -1, 4 limbs
+			// 2.5 = 0x2.8 is stored as the limbs 0, 0, 0x80000000, 2
+			return bytes.size() == 24 + 4 * 4 &&
+				   bytes.substr(0, 4) == "LNUM" && bytes[4] == 1 &&
+				   bytes[8] == 96 && bytes.substr(12, 4) == std::string(4, -1) &&
+				   bytes[16] == 4 && bytes[24 + 11] == '\x80' &&
+				   bytes[24 + 12] == 2;
+		},
+		"Layout is little endian"
+	);
+	testerSerialization.registerTest(
+		[]() {
+			std::stringstream buffer("LNUX");
+			LongNumber::deserialize(buffer);
+			return true;
+		},
+		"Wrong magic = Error", true
+	);
+	testerSerialization.registerTest(
+		[]() {
+			std::stringstream buffer;
+			LongNumber(3, 0).pow(100).serialize(buffer);
+			std::string bytes = buffer.str();
+			bytes.pop_back();
+			std::stringstream truncated(bytes);
+			LongNumber::deserialize(truncated);
+			return true;
+		},
+		"Truncated limbs = Error", true
+	);
+	testerSerialization.registerTest(
+		[]() {
+			// Header of 2^32 - 1 limbs followed by a single one
+			std::stringstream buffer;
+			LongNumber(1, 0).serialize(buffer);
+			std::string bytes = buffer.str();
+			bytes.replace(16, 8, "\xff\xff\xff\xff\0\0\0\0", 8);
+			std::stringstream forged(bytes);
+			try {
+				LongNumber::deserialize(forged);
+			} catch (const std::runtime_error &) {
+				return true;
+			}
+			return false;
+		},
+		"Huge limb count in a short stream = runtime_error"
+	);
+	testerSerialization.registerTest(
+		[]() {
+			// Header of 2^32 - 1 fraction bits without limbs
+			std::stringstream buffer;
+			LongNumber(0, 0).serialize(buffer);
+			std::string bytes = buffer.str();
+			bytes.replace(8, 4, "\xff\xff\xff\xff", 4);
+			std::stringstream forged(bytes);
+			try {
+				LongNumber::deserialize(forged);
+			} catch (const std::runtime_error &) {
+				return bytes.size() == 24;
+			}
+			return false;
+		},
+		"Fraction beyond the limb count = runtime_error"
+	);
+
+	testerSerialization.registerTest(
+		[]() {
+			LongNumber x = LongNumber(-5, 64).pow(77);
+			std::vector<uint32_t> limbs;
+			for (uint32_t i = 0; i < 8; i++) limbs.push_back(x.getChunk(i));
+			return LongNumber::fromLimbs(limbs, true, 64) == x &&
+				   LongNumber::fromLimbs({}, true, 64) == LongNumber(0, 64);
+		},
+		"From limbs"
+	);
+	std::string mappedPath =
+		(std::filesystem::temp_directory_path() / "longarithm-test.lnum")
+			.string();
+	// Writes `x` to `mappedPath`, cut to `bytes` if given
+	auto writeMapped = [=](const LongNumber &x, size_t bytes = SIZE_MAX) {
+		std::stringstream buffer;
+		x.serialize(buffer);
+		std::ofstream file(mappedPath, std::ios::binary | std::ios::trunc);
+		file << buffer.str().substr(0, bytes);
+	};
+	testerSerialization.registerTest(
+		[=]() {
+			uint32_t bits = pi::decimalToBinaryPrecision(3000);
+			LongNumber x = -pi::calculatePi(bits);
+			writeMapped(x);
+			MappedNumber mapped(mappedPath);
+			MappedNumber moved = std::move(mapped);
+			std::filesystem::remove(mappedPath);
+			return moved.toLongNumber() == x && moved.sign() == -1 &&
+				   moved.fractionBits() == bits &&
+				   moved.limbs()[1] == x.getChunk(1) && mapped.limbs().empty();
+		},
+		"Memory-mapped number"
+	);
+	testerSerialization.registerTest(
+		[=]() {
+			writeMapped(LongNumber(3, 0).pow(100), 40);
+			try {
+				MappedNumber mapped(mappedPath);
+			} catch (const std::runtime_error &) {
+				std::filesystem::remove(mappedPath);
+				throw;
+			}
+			return true;
+		},
+		"Truncated mapped file = Error", true
+	);
+	testerSerialization.registerTest(
+		[=]() {
+			MappedNumber mapped(mappedPath + ".missing");
+			return true;
+		},
+		"Missing mapped file = Error", true
+	);
+
+	success &= testerSerialization.runTests();
+
+	// -------------------------------------------------------------------
+	test::Tester testerBigFloat("Floating point");
+	testerBigFloat.registerTest(
+		[]() {
+			LongNumber x = LongNumber(-3, 0).pow(101);
+			return BigFloat(10.625L).toString(3) == "10.625" &&
+				   BigFloat(-0.75L).toString(2) == "-.75" &&
+				   BigFloat(x, 161).toLongNumber(0) == x &&
+				   BigFloat(LongNumber(-2.5L)).toLongNumber(2) ==
+					   -2.5_longnum &&
+				   (BigFloat(1.0L) / BigFloat(3.0L)).toString(20) ==
+					   ".33333333333333333333";
+		},
+		"Conversions"
+	);
+	testerBigFloat.registerTest(
+		[]() {
+			// 1/3 = 0.0101|0101... in binary
+			auto divide = [](long double a, RoundingMode mode) {
+				return BigFloat::div(a, 3.0L, 4, mode);
+			};
+			return divide(1, RoundingMode::TowardZero) == 0.3125L &&
+				   divide(1, RoundingMode::NearestEven) == 0.34375L &&
+				   divide(1, RoundingMode::TowardPositive) == 0.34375L &&
+				   divide(1, RoundingMode::TowardNegative) == 0.3125L &&
+				   divide(-1, RoundingMode::TowardNegative) == -0.34375L &&
+				   divide(-1, RoundingMode::TowardPositive) == -0.3125L &&
+				   divide(-1, RoundingMode::TowardZero) == -0.3125L;
+		},
+		"Directed rounding"
+	);
+	testerBigFloat.registerTest(
+		[]() {
+			auto round = [](long double x, RoundingMode mode) {
+				return BigFloat(x, 64).withPrecision(2, mode);
+			};
+			return round(5, RoundingMode::NearestEven) == 4.0L &&
+				   round(7, RoundingMode::NearestEven) == 8.0L &&
+				   round(5, RoundingMode::NearestAway) == 6.0L &&
+				   round(-5, RoundingMode::NearestAway) == -6.0L &&
+				   round(-5, RoundingMode::NearestEven) == -4.0L &&
+				   round(3, RoundingMode::TowardZero).withPrecision(1) == 4.0L;
+		},
+		"Rounding ties"
+	);
+	testerBigFloat.registerTest(
+		[]() {
+			// Fixed point results with enough fraction bits are exact
+			LongNumber x = LongNumber(7, 0).pow(300) / LongNumber(3, 0).pow(20);
+			LongNumber y = LongNumber(5, 1200).pow(200) >> 1000;
+			x.setPrecision(1200);
+			auto matches = [](const LongNumber &exact, const BigFloat &result) {
+				return BigFloat(exact, 300, RoundingMode::TowardZero) == result;
+			};
+			BigFloat a(x, 4000), b(y, 4000);
+			auto mode = RoundingMode::TowardZero;
+			return matches(x + y, BigFloat::add(a, b, 300, mode)) &&
+				   matches(x - y, BigFloat::sub(a, b, 300, mode)) &&
+				   matches(y - x, BigFloat::sub(b, a, 300, mode)) &&
+				   matches(x * y, BigFloat::mul(a, b, 300, mode)) &&
+				   matches(x / y, BigFloat::div(a, b, 300, mode));
+		},
+		"Same as fixed point"
+	);
+	testerBigFloat.registerTest(
+		[]() {
+			BigFloat one(1.0L, 64), tiny = BigFloat(3.0L) >> 1000000000;
+			BigFloat up =
+				BigFloat::add(one, tiny, 64, RoundingMode::TowardPositive);
+			BigFloat down =
+				BigFloat::sub(one, tiny, 64, RoundingMode::TowardZero);
+			// 1 + 2^-63 and 1 - 2^-64
+			return one + tiny == one && up.getExponent() == -63 &&
+				   up.getMantissa().size() == 2 && down.getExponent() == -64 &&
+				   down.getMantissa().size() == 2 &&
+				   down.getMantissa()[1] == UINT32_MAX &&
+				   (tiny * tiny).getMantissa().size() == 1 &&
+				   tiny * tiny == BigFloat(9.0L) >> 2000000000 &&
+				   (tiny / one).getExponent() == -1000000000;
+		},
+		"Distant magnitudes cost only significant bits"
+	);
+	testerBigFloat.registerTest(
+		[]() {
+			BigFloat x = BigFloat(1.0L) >> 100000;
+			return x < (x << 1) && -x > -(x << 1) && -x < BigFloat() &&
+				   BigFloat() < x && BigFloat(2.5L) == BigFloat(2.5L, 200) &&
+				   BigFloat(-2.5L).compareAbs(2.5L) ==
+					   std::strong_ordering::equal &&
+				   (x - x).getMantissa().empty() && x - x == BigFloat();
+		},
+		"Comparisons"
+	);
+	testerBigFloat.registerTest(
+		[]() {
+			BigFloat::div(1.0L, BigFloat(), 10);
+			return true;
+		},
+		"Division by zero = Error", true
+	);
+	testerBigFloat.registerTest(
+		[]() {
+			BigFloat(1.0L).withPrecision(0);
+			return true;
+		},
+		"Zero precision = Error", true
+	);
+
+	success &= testerBigFloat.runTests();
+
 	// -------------------------------------------------------------------
 	// Reference Pi taken from https://www.piday.org/million/
 	test::Tester testerPi("Pi");
@@ -722,9 +1632,337 @@ int main(void) {
 		"1000 digits of pi"
 	);
 	// clang-format on
+	// Checkpoints go to the temporary directory and are removed at the end
+	std::string checkpointPath =
+		(std::filesystem::temp_directory_path() / "longarithm-test.ckpt")
+			.string();
+	uint32_t checkpointBits = pi::decimalToBinaryPrecision(3000);
+	// Saves after every segment of the series
+	auto testCheckpoint = [=]() {
+		pi::Checkpoint checkpoint;
+		checkpoint.path = checkpointPath;
+		checkpoint.intervalSeconds = 0;
+		return checkpoint;
+	};
+	LongNumber expectedPi = pi::calculatePi(checkpointBits);
+	testerPi.registerTest(
+		[=]() {
+			size_t saves = 0;
+			pi::Checkpoint checkpoint = testCheckpoint();
+			checkpoint.onSave = [&](uint64_t, uint64_t) { saves++; };
+			return pi::calculatePi(checkpointBits, checkpoint) == expectedPi &&
+				   saves > 1 && !std::filesystem::exists(checkpointPath);
+		},
+		"Checkpointed pi = pi, file removed at the end"
+	);
+	testerPi.registerTest(
+		[=]() {
+			// Stops the computation after a few saves as a crash would
+			struct Interrupted {};
+			pi::Checkpoint checkpoint = testCheckpoint();
+			checkpoint.onSave = [](uint64_t terms, uint64_t totalTerms) {
+				if (terms > totalTerms / 3) throw Interrupted();
+			};
+			try {
+				pi::calculatePi(checkpointBits, checkpoint);
+				return false;
+			} catch (const Interrupted &) {
+			}
+			// Starting over would save 1/64 of the terms first
+			std::vector<uint64_t> saves;
+			uint64_t total = 0;
+			checkpoint.resume = true;
+			checkpoint.onSave = [&](uint64_t terms, uint64_t totalTerms) {
+				saves.push_back(terms);
+				total = totalTerms;
+			};
+			LongNumber resumed = pi::calculatePi(checkpointBits, checkpoint);
+			return resumed == expectedPi && !saves.empty() &&
+				   saves.front() > total / 3;
+		},
+		"Resumed pi = pi"
+	);
+	testerPi.registerTest(
+		[=]() {
+			struct Interrupted {};
+			pi::Checkpoint checkpoint = testCheckpoint();
+			checkpoint.onSave = [](uint64_t, uint64_t) { throw Interrupted(); };
+			try {
+				pi::calculatePi(checkpointBits, checkpoint);
+			} catch (const Interrupted &) {
+			}
+			checkpoint.resume = true;
+			checkpoint.onSave = nullptr;
+			try {
+				pi::calculatePi(checkpointBits + 100, checkpoint);
+			} catch (const std::runtime_error &) {
+				std::filesystem::remove(checkpointPath);
+				throw;
+			}
+			return true;
+		},
+		"Resuming with a different precision = Error", true
+	);
 
 	success &= testerPi.runTests();
 
+	// -------------------------------------------------------------------
+	test::Tester testerThreads("Multithreading");
+	// Runs `func` with the given thread count, restores it afterwards
+	auto withThreads = [](unsigned threads, auto func) {
+		unsigned defaults = getThreadCount();
+		setThreadCount(threads);
+		auto result = func();
+		setThreadCount(defaults);
+		return result;
+	};
+	testerThreads.registerTest(
+		[=]() {
+			// Pieces have to be large enough to be multiplied in parallel
+			LongNumber a = bigA.pow(4), b = bigB.pow(4);
+			LongNumber product =
+				withThreads(4, [=]() { return mulWith(a, b, toom3); });
+			return product == mulWith(a, b, schoolbook);
+		},
+		"Toom-3 = schoolbook (4 threads)"
+	);
+	testerThreads.registerTest(
+		[=]() {
+			LongNumber product =
+				withThreads(4, [=]() { return mulWith(bigA, bigB, ntt); });
+			return product == mulWith(bigA, bigB, schoolbook);
+		},
+		"NTT = schoolbook (4 threads)"
+	);
+	testerThreads.registerTest(
+		[=]() {
+			return withThreads(4, []() {
+					   return pi::calculatePi(
+						   pi::decimalToBinaryPrecision(1000)
+					   );
+				   }) ==
+				   pi::calculatePi(pi::decimalToBinaryPrecision(1000));
+		},
+		"1000 digits of pi (4 threads)"
+	);
+	testerThreads.registerTest(
+		[=]() {
+			setThreadCount(0);
+			bool clamped = getThreadCount() == 1;
+			setThreadCount(1);
+			return clamped;
+		},
+		"Thread count is at least 1"
+	);
+
+	success &= testerThreads.runTests();
+
+	// -------------------------------------------------------------------
+	test::Tester testerPool("Limb pool");
+	testerPool.registerTest(
+		[]() {
+			ArenaScope arena;
+			{ LongNumber x(1, 3200); }
+			PoolStatistics first = arena.statistics();
+			for (int i = 0; i < 10; i++) LongNumber x(1, 3200);
+			const PoolStatistics &stats = arena.statistics();
+			return first.misses > 0 && stats.misses == first.misses &&
+				   stats.hits >= first.hits + 10;
+		},
+		"Freed blocks are reused"
+	);
+	testerPool.registerTest(
+		[]() {
+			ArenaScope arena;
+			{ LongNumber x(1, 3200), y(1, 6400); }
+			const PoolStatistics &stats = arena.statistics();
+			return stats.bytes == stats.peakBytes &&
+				   stats.peakBytes >= (3200 + 6400) / 8;
+		},
+		"Cached blocks count towards peak bytes"
+	);
+	testerPool.registerTest(
+		[]() {
+			ArenaScope outer;
+			LongNumber x(1, 3200);
+			size_t misses = outer.statistics().misses;
+			{
+				ArenaScope inner;
+				LongNumber y(1, 3200);
+				if (inner.statistics().misses == 0) return false;
+			}
+			return outer.statistics().misses == misses;
+		},
+		"Innermost scope is used"
+	);
+	testerPool.registerTest(
+		[]() {
+			ArenaScope outer;
+			auto *x = new LongNumber(1, 32000);
+			auto *y = new LongNumber(1, 32000);
+			size_t bytes = outer.statistics().bytes;
+			{
+				ArenaScope inner;
+				delete x;
+			}
+			size_t afterInner = outer.statistics().bytes;
+			std::thread([=]() { delete y; }).join();
+			return afterInner < bytes &&
+				   outer.statistics().bytes < afterInner &&
+				   outer.statistics().peakBytes == bytes;
+		},
+		"Blocks freed by other scopes or threads are not counted"
+	);
+	testerPool.registerTest(
+		[]() {
+			LongNumber x;
+			{
+				ArenaScope arena;
+				x = LongNumber(3, 0).pow(500);
+			}
+			LongNumber y = x;
+			y += 1;
+			return y - 1 == LongNumber(3, 0).pow(500);
+		},
+		"Numbers outlive the scope"
+	);
+	testerPool.registerTest(
+		[=]() {
+			LongNumber expected =
+				pi::calculatePi(pi::decimalToBinaryPrecision(1000));
+			ArenaScope arena;
+			return withThreads(4, []() {
+					   return pi::calculatePi(
+						   pi::decimalToBinaryPrecision(1000)
+					   );
+				   }) == expected &&
+				   arena.statistics().hits > 0;
+		},
+		"1000 digits of pi (4 threads)"
+	);
+
+	success &= testerPool.runTests();
+
+	// -------------------------------------------------------------------
+	test::Tester testerDispatch("CPU dispatch");
+	// Runs `func` with the kernels of `tier`, restores the detected tier
+	auto withTier = [](CpuTier tier, auto func) {
+		setCpuTier(tier);
+		auto result = func();
+		setCpuTier(detectCpuTier());
+		return result;
+	};
+	// Every operation goes through a kernel with several implementations
+	auto dispatched = []() {
+		std::vector<uint32_t> a(301), b(157);
+		for (size_t i = 0; i < a.size(); i++)
+			a[i] = i % 7 == 0 ? UINT32_MAX : 0x9E3779B9 * (i + 1);
+		for (size_t i = 0; i < b.size(); i++)
+			b[i] = i % 5 == 0 ? 0 : 0x85EBCA6B * (i + 3);
+		LongNumber x = LongNumber::fromLimbs(a, false, 0);
+		LongNumber y = LongNumber::fromLimbs(b, true, 0);
+		LongNumber small = LongNumber::fromLimbs(
+			std::span<const uint32_t>(a).first(20), false, 0
+		);
+		return std::vector<LongNumber>{
+			x + y, x - y, x * y, x.square(), small * small,
+			x << 77, x >> 45, x / y
+		};
+	};
+	testerDispatch.registerTest(
+		[]() { return getCpuTier() == detectCpuTier(); },
+		"Detected tier is used by default"
+	);
+	testerDispatch.registerTest(
+		[=]() {
+			std::vector<LongNumber> expected =
+				withTier(CpuTier::Generic, dispatched);
+			for (int tier = 1; tier <= static_cast<int>(detectCpuTier());
+				 tier++) {
+				if (withTier(static_cast<CpuTier>(tier), dispatched) !=
+					expected)
+					return false;
+			}
+			return true;
+		},
+		"Every supported tier matches generic"
+	);
+	testerDispatch.registerTest(
+		[=]() {
+			uint32_t bits = pi::decimalToBinaryPrecision(1000);
+			LongNumber expected = pi::calculatePi(bits);
+			return withTier(CpuTier::Generic, [=]() {
+				return getCpuTier() == CpuTier::Generic &&
+					   pi::calculatePi(bits) == expected;
+			});
+		},
+		"1000 digits of pi on the generic tier"
+	);
+	testerDispatch.registerTest(
+		[]() {
+			setCpuTier(static_cast<CpuTier>(99));
+			return true;
+		},
+		"Unknown tier throws", true
+	);
+	testerDispatch.registerTest(
+		[]() {
+			for (CpuTier tier :
+				 {CpuTier::Generic, CpuTier::BMI2, CpuTier::AVX2,
+				  CpuTier::AVX512})
+				if (parseCpuTier(cpuTierName(tier)) != tier) return false;
+			return !parseCpuTier("sse9").has_value();
+		},
+		"Tier names"
+	);
+	success &= testerDispatch.runTests();
+
+	// -------------------------------------------------------------------
+	// Counters stay at zero unless the tests are built with STATS=1
+	test::Tester testerStats("Instrumentation");
+	auto counterCalls = [](stats::Counter counter) {
+		return stats::snapshot()[static_cast<size_t>(counter)].calls;
+	};
+	testerStats.registerTest(
+		[=]() {
+			LongNumber a = LongNumber(3, 0).pow(2000);
+			LongNumber b = LongNumber(7, 0).pow(1000);
+			stats::reset();
+			LongNumber product = a * b;
+			if (!stats::enabled())
+				return counterCalls(stats::Counter::Multiply) == 0;
+			stats::Entry multiply =
+				stats::snapshot()[static_cast<size_t>(stats::Counter::Multiply)];
+			// 3^2000 and 7^1000 take 100 and 88 chunks
+			return multiply.calls == 1 && multiply.limbs == 100 + 88 &&
+				   counterCalls(stats::Counter::MulKaratsuba) > 0;
+		},
+		"Multiplication is counted with its kernel tier"
+	);
+	testerStats.registerTest(
+		[=]() {
+			LongNumber x = LongNumber(1, 0) << 1000;
+			x += 1;
+			stats::reset();
+			for (const stats::Entry &entry : stats::snapshot())
+				if (entry.calls || entry.limbs || entry.nanoseconds)
+					return false;
+			return true;
+		},
+		"Reset clears every counter"
+	);
+	testerStats.registerTest(
+		[=]() {
+			stats::reset();
+			LongNumber x = LongNumber(2, 640).sqrt();
+			return !stats::enabled() ||
+				   counterCalls(stats::Counter::Root) == 1;
+		},
+		"Square root is counted as a root"
+	);
+
+	success &= testerStats.runTests();
+
 	// -------------------------------------------------------------------
 	test::Tester testerAbs("Abs");
 	testerAbs.registerTest(